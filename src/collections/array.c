@@ -1,3 +1,4 @@
+#define MEMORY_SUBSYSTEM MEMORY_ARRAY
 #include "array.h"
 #include <string.h>
 
@@ -5,11 +6,18 @@ void _array_try_expand(Array* array);
 void _array_move_down(Array* array, size_t removed);
 
 Array* array_new(size_t capacity, size_t element_size) {
-	Array* array = allocate(sizeof(Array));
+	return array_new_with(capacity, element_size, allocator_default());
+}
+
+Array* array_new_with(size_t capacity, size_t element_size, Allocator* allocator) {
+	ASSERT_NONNULL(allocator);
+
+	Array* array = allocator_allocate(allocator, sizeof(Array));
 	array->capacity = capacity;
 	array->count = 0;
 	array->element_size = element_size;
-	array->data = allocate(sizeof(void*) * capacity);
+	array->allocator = allocator;
+	array->data = allocator_allocate(allocator, element_size * capacity);
 
 	return array;
 }
@@ -17,20 +25,21 @@ Array* array_new(size_t capacity, size_t element_size) {
 Array* array_clone(Array* array) {
 	ASSERT_NONNULL(array);
 
-	Array* clone = allocate(sizeof(Array));
+	Array* clone = allocator_allocate(array->allocator, sizeof(Array));
 	clone->capacity = array->capacity;
 	clone->count = array->count;
 	clone->element_size = array->element_size;
-	clone->data = allocate(sizeof(void*) * array->capacity);
+	clone->allocator = array->allocator;
+	clone->data = allocator_allocate(array->allocator, array->element_size * array->capacity);
 
-	memcpy(clone->data, array->data, sizeof(void*) * array->count);
+	memcpy(clone->data, array->data, array->element_size * array->count);
 
 	return clone;
 }
 
 void array_free(Array* array) {
-	free(array->data);
-	free(array);
+	allocator_free(array->allocator, array->data, array->element_size * array->capacity);
+	allocator_free(array->allocator, array, sizeof(Array));
 }
 
 void array_add(Array* array, void* element) {
@@ -155,6 +164,12 @@ void array_remove(Array* array, size_t index) {
 	array->count--;
 }
 
+void array_clear(Array* array) {
+	ASSERT_NONNULL(array);
+
+	array->count = 0;
+}
+
 ArraySplice* array_splice_from(Array* array, size_t start, size_t count) {
 	ASSERT_NONNULL(array);
 	ASSERT_VALID_BOUNDS(array, (int) start, (int) array->count);
@@ -206,7 +221,7 @@ char* array_splice_get_cstring(ArraySplice* splice, size_t index) {
 
 void array_splice_free(ArraySplice* splice) {
 	ASSERT_NONNULL(splice);
-	free(splice);
+	deallocate(splice);
 }
 
 void _array_try_expand(Array* array) {
@@ -214,13 +229,20 @@ void _array_try_expand(Array* array) {
 		return;
 	}
 
+	size_t old_capacity = array->capacity;
+
 	if (array->capacity == 0) {	
 		array->capacity = 2;
 	} else {	
 		array->capacity = array->capacity * 2;
 	}
 
-	array->data = reallocate(array->data, sizeof(void*) * array->capacity);
+	array->data = allocator_reallocate(
+				array->allocator,
+				array->data,
+				array->element_size * old_capacity,
+				array->element_size * array->capacity
+			);
 }
 
 void _array_move_down(Array* array, size_t removed) {
@@ -229,7 +251,7 @@ void _array_move_down(Array* array, size_t removed) {
     size_t dest_offset = removed * array->element_size;
 	char* src = (char*) array->data + start_offset;
 	char* dest = (char*) array->data + dest_offset;
-    memcpy(dest, src, elements_count * array->element_size);
+    memmove(dest, src, elements_count * array->element_size);
 }
 
 
@@ -5,6 +5,7 @@
 #include "../error/error.h"
 #include "../safety/option.h"
 #include "../memory/memory.h"
+#include "../memory/allocator.h"
 
 /**
  * Array defines a collection of void pointers to some generic data type. 
@@ -14,12 +15,14 @@
  * Unlike other data structures, this comes with automatic safe types for primitive 
  * types for ease of access
  * 
+ * The array struct and its data are allocated through "allocator" (see `array_new_with()`)
  */
 typedef struct {
 	void* data;
 	size_t count;
 	size_t capacity;
 	size_t element_size;
+	Allocator* allocator;
 } Array;
 
 OPTION_TYPE(Array*, Array, array, NULL)
@@ -43,6 +46,11 @@ OPTION_TYPE(ArraySplice, ArraySplice, array_splice, DEFAULT_ARRAY_SPLICE)
  */
 Array* array_new(size_t capacity, size_t element_size);
 
+/**
+ * Same as `array_new()`, but the array struct and its data are allocated through the given allocator
+ */
+Array* array_new_with(size_t capacity, size_t element_size, Allocator* allocator);
+
 /**
  * Returns a deep clone of the passed `array`
  */
@@ -124,6 +132,11 @@ char* array_get_cstring(Array* array, size_t index);
  */
 void array_remove(Array* array, size_t index);
 
+/**
+ * Removes every element from the array while keeping its capacity for reuse
+ */
+void array_clear(Array* array);
+
 /**
  * Returns a splice of a given array with guaranteed null safety.
  * This allocates only `3 * size_t` bytes of data
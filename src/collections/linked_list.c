@@ -1,10 +1,24 @@
+#define MEMORY_SUBSYSTEM MEMORY_LIST
 #include "linked_list.h"
 #include "../error/error.h"
 
+Node* _linked_node_new(LinkedList* list, void* element);
+void _linked_node_release(LinkedList* list, Node* node);
+Allocator* _linked_node_allocator(LinkedList* list);
+
 Node* linked_node_new(void* element, Node* next) {
+	return linked_node_new_with(element, next, allocator_default());
+}
+
+Node* linked_node_new_in(void* element, Node* next, Pool* pool) {
+	ASSERT_NONNULL(pool);
+	return linked_node_new_with(element, next, &pool->allocator);
+}
+
+Node* linked_node_new_with(void* element, Node* next, Allocator* allocator) {
 	ASSERT_NONNULL(element);
 
-	Node* node = allocate(sizeof(Node));	
+	Node* node = allocator_allocate(allocator, sizeof(Node));	
 	node->element = element;
 	node->next = next;
 
@@ -16,19 +30,35 @@ void linked_node_free(LinkedList* list, Node* node) {
 	ASSERT_NONNULL(node);
 
 	list->destructor(node->element);
-	free(node);	
+	_linked_node_release(list, node);
 }
 
 LinkedList* linked_list_new(Node* head, Destructor destructor, Duplicator duplicator) {
+	return linked_list_new_with(head, destructor, duplicator, allocator_default());
+}
+
+LinkedList* linked_list_new_in(Node* head, Destructor destructor, Duplicator duplicator, Pool* pool) {
+	ASSERT_NONNULL(pool);
+
+	LinkedList* list = linked_list_new(head, destructor, duplicator);
+	list->pool = pool;
+
+	return list;
+}
+
+LinkedList* linked_list_new_with(Node* head, Destructor destructor, Duplicator duplicator, Allocator* allocator) {
 	ASSERT_NONNULL(head);
 	ASSERT_NONNULL(destructor);
 	ASSERT_NONNULL(duplicator);
+	ASSERT_NONNULL(allocator);
 
-	LinkedList* list = allocate(sizeof(LinkedList));
+	LinkedList* list = allocator_allocate(allocator, sizeof(LinkedList));
 	list->destructor = destructor;
 	list->duplicator = duplicator;
 	list->count= 1;
 	list->head = head;
+	list->pool = NULL;
+	list->allocator = allocator;
 
 	return list;
 }
@@ -57,24 +87,26 @@ void linked_list_push(LinkedList* list, Node* next) {
 LinkedList* linked_list_clone(LinkedList* list) {
 	ASSERT_NONNULL(list);
 
-	LinkedList* clone = allocate(sizeof(LinkedList));
+	LinkedList* clone = allocator_allocate(list->allocator, sizeof(LinkedList));
 	clone->destructor = list->destructor;
 	clone->duplicator = list->duplicator;
 	clone->count= list->count;
+	clone->pool = list->pool;
+	clone->allocator = list->allocator;
+	clone->head = NULL;
 
 	if (linked_list_headless(list)) {
 		return clone;	
 	}	
 
-	clone->head = allocate(sizeof(Node));
-	clone->head->element = list->duplicator(list->head->element);
+	clone->head = _linked_node_new(clone, list->duplicator(list->head->element));
 
 	Node* temp = list->head;
 	Node* clone_temp = clone->head;
 
 	while (temp->next != NULL) {
 		temp = temp->next;	
-		clone_temp->next = linked_node_new(list->duplicator(temp->element), NULL);
+		clone_temp->next = _linked_node_new(clone, list->duplicator(temp->element));
 		clone_temp = clone_temp->next;
 	}
 
@@ -91,12 +123,12 @@ void linked_list_free(LinkedList* list) {
 		while (temp != NULL) {
 			temp = temp->next;	
 			list->destructor(free_temp->element);
-			free(free_temp);
+			_linked_node_release(list, free_temp);
 			free_temp = temp;
 		}
 	} 
 	
-	free(list);
+	allocator_free(list->allocator, list, sizeof(LinkedList));
 }
 
 bool linked_list_headless(LinkedList* list) {
@@ -215,3 +247,16 @@ void linked_list_delete(LinkedList* list, size_t index) {
 	linked_node_free(list, linked_list_pop(list, index));	
 }
 
+// INTERNAL
+
+Node* _linked_node_new(LinkedList* list, void* element) {
+	return linked_node_new_with(element, NULL, _linked_node_allocator(list));
+}
+
+void _linked_node_release(LinkedList* list, Node* node) {
+	allocator_free(_linked_node_allocator(list), node, sizeof(Node));
+}
+
+Allocator* _linked_node_allocator(LinkedList* list) {
+	return list->pool != NULL ? &list->pool->allocator : list->allocator;
+}
@@ -3,6 +3,8 @@
 
 #include "../memory/memory.h"
 #include "../safety/option.h"
+#include "../memory/pool.h"
+#include "../memory/allocator.h"
 #include <stdbool.h>
 #include <stdlib.h>
 
@@ -24,13 +26,17 @@ typedef struct Node Node;
 OPTION_TYPE(Node*, Node, node, NULL)
 
 /**
- * LinkedList defines a singly linked list of nodes
+ * LinkedList defines a singly linked list of nodes.
+ * The list and its nodes are allocated through "allocator", unless "pool" is non-null
+ * in which case every node is taken from and released to that pool
  */
 typedef struct {
 	Node* head;
 	Destructor destructor;
 	Duplicator duplicator;
 	size_t count;
+	Pool* pool;
+	Allocator* allocator;
 } LinkedList;
 
 OPTION_TYPE(LinkedList*, LinkedList, linked_list, NULL)
@@ -49,7 +55,19 @@ OPTION_TYPE(LinkedList*, LinkedList, linked_list, NULL)
 Node* linked_node_new(void* element, Node* next);
 
 /**
- * Frees the given node and its element from the linked list. Does not
+ * Crates a new node taken from the given pool which takes ownership of the given element.
+ * The pool must hold objects of at least `sizeof(Node)` bytes
+ */
+Node* linked_node_new_in(void* element, Node* next, Pool* pool);
+
+/**
+ * Crates a new node allocated through the given allocator which takes ownership of the given element
+ */
+Node* linked_node_new_with(void* element, Node* next, Allocator* allocator);
+
+/**
+ * Frees the given node and its element from the linked list.
+ * Nodes popped from a pooled list should be freed with this so they return to the pool. Does not
  * modify any part of the list
  */
 void linked_node_free(LinkedList* list, Node* node);
@@ -60,6 +78,19 @@ void linked_node_free(LinkedList* list, Node* node);
  */
 LinkedList* linked_list_new(Node* head, Destructor destructor, Duplicator duplicator);
 
+/**
+ * Creates a linked list whose nodes are recycled through the given pool.
+ * The head and every pushed node must come from `linked_node_new_in()` with the same pool.
+ * The list does not own the pool, so one pool can be shared by many lists.
+ */
+LinkedList* linked_list_new_in(Node* head, Destructor destructor, Duplicator duplicator, Pool* pool);
+
+/**
+ * Creates a linked list whose struct and nodes are allocated through the given allocator.
+ * The head and every pushed node must come from `linked_node_new_with()` with the same allocator.
+ */
+LinkedList* linked_list_new_with(Node* head, Destructor destructor, Duplicator duplicator, Allocator* allocator);
+
 /**
  * Pushes a non-null node onto the linked list
  */
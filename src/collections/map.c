@@ -1,15 +1,35 @@
+#define MEMORY_SUBSYSTEM MEMORY_MAP
 #include "map.h"
-#include "linked_list.h"
 #include "vector.h"
 #include "map/entry_set.h"
 #include "../error/error.h"
+#include "../hash/hash.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <time.h>
 
-void _map_insert(Map* map, EntrySet* entry_set, void* key, void* value, bool should_rehash);
+void _map_insert(Map* map, void* key, void* value);
+Entry* _map_claim(Map* map, void* key, bool* found);
+Entry* _map_claim_hashed(Map* map, size_t hash, void* key, EqualityChecker comparator, bool* found);
 void _map_rehash(Map* map);
-size_t _map_index_from_hash(Map* map, size_t hash);
+void _map_migrate(Map* map, size_t slots);
+size_t _map_find(Map* map, size_t hash, void* key, EqualityChecker comparator, EntrySet** owner);
+size_t _map_hash(Map* map, void* key);
+size_t _map_mix(Map* map, size_t hash);
+size_t _map_seed();
+bool _map_view_equals(void* view, void* key);
+Allocator* _map_entry_allocator(Map* map);
+
+/**
+ * Borrowed key passed through `entry_set_find()` for the view lookups
+ */
+typedef struct {
+	const char* key;
+	size_t length;
+	ViewEqualityChecker comparator;
+} MapView;
+size_t _map_capacity_for(size_t entry_count);
 
 Map* map_new(
 		size_t initial_capacity,
@@ -21,14 +41,38 @@ Map* map_new(
 		Duplicator value_duplicator
 	) {
 
+	return map_new_with(
+				initial_capacity,
+				key_hasher,
+				key_comparator,
+				key_destructor,
+				value_destructor,
+				key_duplicator,
+				value_duplicator,
+				allocator_default()
+			);
+}
+
+Map* map_new_with(
+		size_t initial_capacity,
+		Hasher key_hasher,
+		EqualityChecker key_comparator,
+		Destructor key_destructor,
+		Destructor value_destructor,
+		Duplicator key_duplicator,
+		Duplicator value_duplicator,
+		Allocator* allocator
+	) {
+
 	ASSERT_NONNULL(key_comparator);		
 	ASSERT_NONNULL(key_hasher);		
 	ASSERT_NONNULL(key_destructor);		
 	ASSERT_NONNULL(value_destructor);		
 	ASSERT_NONNULL(key_duplicator);
 	ASSERT_NONNULL(value_duplicator);
+	ASSERT_NONNULL(allocator);
 
-	Map* map = allocate(sizeof(Map));
+	Map* map = allocator_allocate(allocator, sizeof(Map));
 	map->entry_count = 0;
 	map->key_hasher = key_hasher;
 	map->key_comparator = key_comparator;
@@ -36,9 +80,15 @@ Map* map_new(
 	map->value_destructor = value_destructor;
 	map->key_duplicator = key_duplicator;
 	map->value_duplicator = value_duplicator;
+	map->previous = NULL;
+	map->growing = NULL;
+	map->migrated = 0;
+	map->incremental = false;
+	map->entry_pool = NULL;
+	map->allocator = allocator;
+	map->seed = _map_seed();
 
-	initial_capacity = (initial_capacity <= 0 ? 1 : initial_capacity);
-	map->entries = entry_set_new(initial_capacity);
+	map->entries = entry_set_new_with(_map_capacity_for(initial_capacity), allocator, allocator);
 
 	return map;
 }
@@ -46,7 +96,7 @@ Map* map_new(
 Map* map_clone(Map* map) {
 	ASSERT_NONNULL(map);
 
-	Map* clone= allocate(sizeof(Map));
+	Map* clone= allocator_allocate(map->allocator, sizeof(Map));
 	clone->entry_count = map->entry_count;
 	clone->key_destructor = map->key_destructor;
 	clone->value_destructor = map->value_destructor;
@@ -54,169 +104,285 @@ Map* map_clone(Map* map) {
 	clone->value_duplicator = map->value_duplicator;
 	clone->key_hasher = map->key_hasher;
 	clone->key_comparator = map->key_comparator;
+	clone->migrated = map->migrated;
+	clone->incremental = map->incremental;
+	clone->entry_pool = map->entry_pool;
+	clone->allocator = map->allocator;
+	clone->seed = map->seed;
 
 	clone->entries = entry_set_clone(map->entries, map->key_duplicator, map->value_duplicator);
+	clone->previous = NULL;
+
+	// a table still being prepared holds no entries, so the clone simply starts its own growth later
+	clone->growing = NULL;
+
+	if (map->previous != NULL) {
+		clone->previous = entry_set_clone(map->previous, map->key_duplicator, map->value_duplicator);
+	}
+
 	return clone;
 }
 
 void map_free(Map* map) {
 	entry_set_free(map->entries, map->key_destructor, map->value_destructor, true);
-	free(map);
+
+	if (map->previous != NULL) {
+		entry_set_free(map->previous, map->key_destructor, map->value_destructor, true);
+	}
+
+	if (map->growing != NULL) {
+		entry_set_free(map->growing, map->key_destructor, map->value_destructor, false);
+	}
+
+	allocator_free(map->allocator, map, sizeof(Map));
 }
 
-void map_insert(Map* map, void* key, void* value) {
-	_map_insert(map, map->entries, key, value, true);
+void map_set_entry_pool(Map* map, Pool* pool) {
+	ASSERT_NONNULL(map);
+
+	if (map->entry_count > 0) {
+		printf("\nPOOL ERROR: the entry pool of a map can only be set while it is empty\nSee: %s (line %d)\n", __FILE__, __LINE__);
+		exit(EXIT_FAILURE);
+	}
+
+	map->entry_pool = pool;
+	map->entries->entry_allocator = _map_entry_allocator(map);
+
+	if (map->growing != NULL) {
+		map->growing->entry_allocator = map->entries->entry_allocator;
+	}
 }
 
-void* map_get_value(Map* map, void* key, bool discard_key) {	
-	return map_get_entry(map, key, discard_key)->value;
+void map_entry_free(Map* map, Entry* entry) {
+	ASSERT_NONNULL(map);
+	ASSERT_NONNULL(entry);
+
+	entry_free_with(entry, map->key_destructor, map->value_destructor, _map_entry_allocator(map));
 }
 
-Entry* map_get_entry(Map* map, void* key, bool discard_key) {
-	size_t index = _map_index_from_hash(map, map->key_hasher(key));
+void map_set_incremental_rehash(Map* map, bool incremental) {
+	ASSERT_NONNULL(map);
 
-	if (index >= map->entries->capacity || map->entries->data[index] == NULL) {
-		if (discard_key) {
-			map->key_destructor(key);
-		}
-		return NULL;
+	// leaving incremental mode finishes any growth still in progress
+	if (!incremental) {
+		_map_migrate(map, SIZE_MAX);
 	}
 
-	LinkedList* entries = entry_set_get(map->entries, index);
+	map->incremental = incremental;
+}
 
-	if (entries == NULL) {
-		if (discard_key) {
-			map->key_destructor(key);
-		}
-		return NULL;
+void map_insert(Map* map, void* key, void* value) {
+	_map_insert(map, key, value);
+}
+
+void** map_try_insert(Map* map, void* key, void* value, bool* inserted) {
+	ASSERT_NONNULL(value);
+
+	bool found;
+	Entry* entry = _map_claim(map, key, &found);
+
+	if (found) {
+		map->key_destructor(key);
+		map->value_destructor(value);
+	} else {
+		entry->value = value;
+	}
+
+	if (inserted != NULL) {
+		*inserted = !found;
 	}
 
-	Node* iterator = entries->head;
+	return &entry->value;
+}
 
-	// find entry matching key exactly when hash collides
-	while (iterator != NULL) {	
-		Entry* entry = ((Entry*) iterator->element);
-		if (map->key_comparator(key, entry->key)) {
-			if (discard_key) {
-				map->key_destructor(key);
-			}
-			return entry;
-		}
-		iterator = iterator->next;
+void** map_get_or_insert(Map* map, void* key, Supplier supplier) {
+	ASSERT_NONNULL(supplier);
+
+	bool found;
+	Entry* entry = _map_claim(map, key, &found);
+
+	if (found) {
+		map->key_destructor(key);
+		return &entry->value;
+	}
+
+	entry->value = supplier(entry->key);
+	ASSERT_NONNULL(entry->value);
+
+	return &entry->value;
+}
+
+void** map_upsert(Map* map, void* key, void* value, Updater updater) {
+	ASSERT_NONNULL(value);
+	ASSERT_NONNULL(updater);
+
+	bool found;
+	Entry* entry = _map_claim(map, key, &found);
+
+	if (found) {
+		updater(entry->value, value);
+		map->key_destructor(key);
+		map->value_destructor(value);
+	} else {
+		entry->value = value;
 	}
 
+	return &entry->value;
+}
+
+void* map_get_value(Map* map, void* key, bool discard_key) {	
+	Entry* entry = map_get_entry(map, key, discard_key);
+	return entry == NULL ? NULL : entry->value;
+}
+
+Entry* map_get_entry(Map* map, void* key, bool discard_key) {
+	ASSERT_NONNULL(map);
+	ASSERT_NONNULL(key);
+
+	_map_migrate(map, MAP_REHASH_STEP);
+
+	EntrySet* owner;
+	size_t index = _map_find(map, _map_hash(map, key), key, map->key_comparator, &owner);
+
 	if (discard_key) {
 		map->key_destructor(key);
 	}
 
-	// return NULL if no match occurs
-	return NULL;
-}
-
-// Does not delete entry
-Entry* _override_vector_remove(Map* map, LinkedList* list, size_t list_index, size_t vector_index) { 
-	// Delete element later in list
-	if (list_index > 0) {
-		Node* removed = linked_list_pop(list, list_index);
-		Entry* entry = removed->element;
-		free(removed);
-		map->entry_count--;
-		return entry;
-	} 
-
-	// delete first element, but move sequential elements back one
-	if (list->head->next != NULL) {
-		Node* removed = linked_list_pop_head(list);
-		Entry* entry = removed->element;
-		free(removed);
-		map->entry_count--;
-		return entry;
-	}
-
-	// delete first element, then the entire list
-	Node* head = linked_list_pop_head(list);
-	Entry* entry = head->element;
-	free(head);
-	free(list);
-	map->entries->data[vector_index] = NULL;
-	map->entry_count--;
-	
-	return entry;
+	if (index == ENTRY_SET_NOT_FOUND) {
+		return NULL;
+	}
+
+	return entry_set_get(owner, index);
 }
 
-Entry* map_remove(Map* map, void* key, bool discard_key) {
-	size_t index = _map_index_from_hash(map, map->key_hasher(key));
+bool map_contains(Map* map, void* key, bool discard_key) {
+	return map_get_entry(map, key, discard_key) != NULL;
+}
+
+void* map_get_value_view(Map* map, const char* key, size_t length, ViewHasher hasher, ViewEqualityChecker comparator) {
+	Entry* entry = map_get_entry_view(map, key, length, hasher, comparator);
+	return entry == NULL ? NULL : entry->value;
+}
+
+Entry* map_get_entry_view(Map* map, const char* key, size_t length, ViewHasher hasher, ViewEqualityChecker comparator) {
+	ASSERT_NONNULL(map);
+	ASSERT_NONNULL(key);
+	ASSERT_NONNULL(hasher);
+	ASSERT_NONNULL(comparator);
 
-	if (index >= map->entries->capacity || map->entries->data[index] == NULL) {
+	_map_migrate(map, MAP_REHASH_STEP);
+
+	EntrySet* owner;
+	MapView view = { key, length, comparator };
+	size_t index = _map_find(map, _map_mix(map, hasher(key, length)), &view, _map_view_equals, &owner);
+
+	if (index == ENTRY_SET_NOT_FOUND) {
 		return NULL;
 	}
 
-	LinkedList* entries = entry_set_get(map->entries, index);
+	return entry_set_get(owner, index);
+}
+
+bool map_contains_view(Map* map, const char* key, size_t length, ViewHasher hasher, ViewEqualityChecker comparator) {
+	return map_get_entry_view(map, key, length, hasher, comparator) != NULL;
+}
+
+Entry* map_remove_view(Map* map, const char* key, size_t length, ViewHasher hasher, ViewEqualityChecker comparator) {
+	ASSERT_NONNULL(map);
+	ASSERT_NONNULL(key);
+	ASSERT_NONNULL(hasher);
+	ASSERT_NONNULL(comparator);
+
+	_map_migrate(map, MAP_REHASH_STEP);
 
-	if (entries == NULL) {
+	EntrySet* owner;
+	MapView view = { key, length, comparator };
+	size_t index = _map_find(map, _map_mix(map, hasher(key, length)), &view, _map_view_equals, &owner);
+
+	if (index == ENTRY_SET_NOT_FOUND) {
 		return NULL;
 	}
 
-	Node* iterator = entries->head;
+	map->entry_count--;
+	return entry_set_erase(owner, index);
+}
 
-	// find entry matching key exactly when hash collides
-	size_t list_index = 0;
-	while (iterator != NULL) {	
-		Entry* next = ((Entry*) iterator->element);
+Entry* map_claim_view(Map* map, const char* key, size_t length, ViewHasher hasher, ViewEqualityChecker comparator, bool* found) {
+	ASSERT_NONNULL(map);
+	ASSERT_NONNULL(key);
+	ASSERT_NONNULL(hasher);
+	ASSERT_NONNULL(comparator);
+	ASSERT_NONNULL(found);
 
-		if (map->key_comparator(key, next->key)) {
-			Entry* removed = _override_vector_remove(map, entries, list_index, index);
-			if (discard_key) {
-				map->key_destructor(key);
-			}
-			return removed;
-		}
+	_map_migrate(map, MAP_REHASH_STEP);
 
-		iterator = iterator->next;
-		list_index++;
+	MapView view = { key, length, comparator };
+	Entry* entry = _map_claim_hashed(map, _map_mix(map, hasher(key, length)), &view, _map_view_equals, found);
+
+	// the borrowed view only stood in for the key during the probe
+	if (!*found) {
+		entry->key = NULL;
 	}
 
+	return entry;
+}
+
+void map_delete_view(Map* map, const char* key, size_t length, ViewHasher hasher, ViewEqualityChecker comparator) {
+	Entry* retrieved = map_remove_view(map, key, length, hasher, comparator);
+	if (retrieved) {
+		map_entry_free(map, retrieved);
+	}	
+}
+
+Entry* map_remove(Map* map, void* key, bool discard_key) {
+	ASSERT_NONNULL(map);
+	ASSERT_NONNULL(key);
+
+	_map_migrate(map, MAP_REHASH_STEP);
+
+	EntrySet* owner;
+	size_t index = _map_find(map, _map_hash(map, key), key, map->key_comparator, &owner);
+
 	if (discard_key) {
 		map->key_destructor(key);
 	}
 
 	// return null if nothing found 
-	return NULL;
+	if (index == ENTRY_SET_NOT_FOUND) {
+		return NULL;
+	}
+
+	map->entry_count--;
+	return entry_set_erase(owner, index);
 }
 
 void map_delete(Map* map, void* key, bool discard_key) {
 	Entry* retrieved = map_remove(map, key, discard_key);
 	if (retrieved) {
-		entry_free(retrieved, map->key_destructor, map->value_destructor);
+		map_entry_free(map, retrieved);
 	}	
 }
 
-size_t _map_index_from_hash(Map* map, size_t hash) {
-	size_t divisor = map->entries->capacity == 0 ? 1 : map->entries->capacity;
-	size_t index = hash % divisor;
-	
-	return index;	
-}
-
-
 // SPLICE
 
 
 MapSplice map_splice_from(Map* map) {
-	Vector* entries = vector_new(map->entries->count, duplicator_empty, destructor_empty);
+	Vector* entries = vector_new(map->entry_count, duplicator_empty, destructor_empty);
 
 	for (size_t i = 0; i < map->entries->capacity; i++) {
-		LinkedList* entry_list = map->entries->data[i];
+		Entry* entry = map->entries->data[i];
 
-		if (entry_list == NULL) {
-			continue;
+		if (entry != NULL) {
+			vector_add(entries, entry);
 		}
+	}
 
-		Node* iterator = entry_list->head;
+	// entries not yet migrated by an incremental rehash
+	for (size_t i = 0; map->previous != NULL && i < map->previous->capacity; i++) {
+		Entry* entry = map->previous->data[i];
 
-		while (iterator != NULL) {
-			vector_add(entries, iterator->element);
-			iterator = iterator->next;
+		if (entry != NULL) {
+			vector_add(entries, entry);
 		}
 	}
 	
@@ -228,8 +394,10 @@ MapSplice map_splice_from(Map* map) {
 }
 
 void map_splice_free(MapSplice* splice) {
-	free(splice->entries->data);
-	free(splice->entries);
+	Vector* entries = splice->entries;
+
+	allocator_free(entries->allocator, entries->data, sizeof(void*) * entries->capacity);
+	allocator_free(entries->allocator, entries, sizeof(Vector));
 }
 
 Entry* map_splice_get_entry(MapSplice* splice, size_t index) {
@@ -247,83 +415,198 @@ void* map_splice_get_value(MapSplice* splice, size_t index) {
 // INTERNAL FUNCTIONS
 
 
-void _map_insert(Map* map, EntrySet* entries, void* key, void* value, bool should_rehash) {
+void _map_insert(Map* map, void* key, void* value) {
+	ASSERT_NONNULL(value);
+
+	bool found;
+	Entry* entry = _map_claim(map, key, &found);
+
+	// Duplicate found, replace the stored pair
+	if (found) {
+		map->key_destructor(entry->key);
+		map->value_destructor(entry->value);
+		entry->key = key;
+	}
+
+	entry->value = value;
+}
+
+// Returns the entry for the key, or stores a new entry with a null value if the key is missing.
+// The key is hashed once and the current table is probed once.
+Entry* _map_claim(Map* map, void* key, bool* found) {
 	ASSERT_NONNULL(map);
 	ASSERT_NONNULL(key);
-	ASSERT_NONNULL(value);
 
-	size_t index = _map_index_from_hash(map, map->key_hasher(key));
-
-	// Existing hash found
-	if (entries->data[index] != NULL) {
-		LinkedList* list = entries->data[index];
-		Entry* existing = list->head->element;
-
-		// Duplicates foun;
-		if (map->key_comparator(existing->key, key)) {
-			map->key_destructor(existing->key);
-			map->value_destructor(existing->value);
-			existing->key = key;
-			existing->value = value;
-		} else {
-			Node* node = linked_node_new(entry_new(key, value), NULL);
-			linked_list_push(list, node);
-			map->entry_count++;
-		}
+	_map_migrate(map, MAP_REHASH_STEP);
 
-		return;
+	return _map_claim_hashed(map, _map_hash(map, key), key, map->key_comparator, found);
+}
+
+// Same as `_map_claim()` for a key already hashed and mixed, found with the given comparator
+Entry* _map_claim_hashed(Map* map, size_t hash, void* key, EqualityChecker comparator, bool* found) {
+	size_t slot = ENTRY_SET_NOT_FOUND;
+	size_t index = entry_set_find_or_slot(map->entries, hash, key, comparator, &slot);
+	*found = true;
+
+	if (index != ENTRY_SET_NOT_FOUND) {
+		return entry_set_get(map->entries, index);
 	}
 
-	// Nothing existing for hash, create new entry	
-	LinkedList* list_new = linked_list_new(
-				linked_node_new(
-						entry_new(key, value),
-						NULL
-					), 
-				map->value_destructor, 
-				map->value_duplicator
-			);
+	if (map->previous != NULL) {
+		index = entry_set_find(map->previous, hash, key, comparator);
 
-	bool did_change_capacity = entry_set_set(entries, map->entry_count, index, list_new, should_rehash);
-	map->entry_count++;
+		if (index != ENTRY_SET_NOT_FOUND) {
+			return entry_set_get(map->previous, index);
+		}
+	}
 
-	if (should_rehash && did_change_capacity) {	
+	if (entry_set_needs_growth(map->entries)) {
 		_map_rehash(map);
-	} 
+		slot = entry_set_find_slot(map->entries, hash);
+	}
+
+	Entry* entry = entry_new_with(key, NULL, _map_entry_allocator(map));
+	entry_set_set(map->entries, slot, hash, entry);
+	map->entry_count++;
+	*found = false;
+
+	return entry;
 }
 
 void _map_rehash(Map* map_existing) {
-	// Create new vector, but keep old map (only free old vector and replace with this)
-	size_t original_entry_count = map_existing->entry_count;
-	EntrySet* entries_rehashed = entry_set_new(map_existing->entries->capacity);
+	EntrySet* entries = map_existing->entries;
+
+	// while the next table is prepared, the current one keeps taking entries as long as it has room
+	if (map_existing->growing != NULL && entries->count + entries->tombstones + 1 < entries->capacity) {
+		return;
+	}
+
+	// a growth still in progress must finish before the next one starts
+	_map_migrate(map_existing, SIZE_MAX);
+
+	if (entries != map_existing->entries && !entry_set_needs_growth(map_existing->entries)) {
+		return;
+	}
+
+	entries = map_existing->entries;
+	size_t capacity = entries->capacity;
+
+	// mostly tombstones, rebuilding at the same capacity is enough to reclaim them
+	if ((float) (entries->count + 1) > capacity * MAP_LOAD_SIZE / 2) {
+		capacity *= 2;
+	}
 
-	for (size_t i = 0; i < entries_rehashed->capacity; i++) {
-		entries_rehashed->data[i] = NULL; 
+	// Let later operations prepare the new table and then move the old slots over
+	if (map_existing->incremental) {
+		map_existing->growing = entry_set_new_unprepared(capacity, map_existing->allocator, _map_entry_allocator(map_existing));
+		return;
 	}
 
-	// Place old entires into new entries with rehash
-	for (size_t i = 0; i < map_existing->entries->capacity; i++) {		
-		LinkedList* list = map_existing->entries->data[i];
-		if (list == NULL) {
+	EntrySet* entries_rehashed = entry_set_new_with(capacity, map_existing->allocator, _map_entry_allocator(map_existing));
+
+	// Move existing entries into the new table without reallocating or rehashing them
+	for (size_t i = 0; i < entries->capacity; i++) {		
+		Entry* entry = entries->data[i];
+		if (entry == NULL) {
 			continue;	
 		}
 
-		Node* iterator = list->head;
-
-		while (iterator != NULL) {	
-			Entry* entry = iterator->element;
-			_map_insert(map_existing, entries_rehashed,entry->key, entry->value, false);				
-			iterator = iterator->next;	
-		}	
+		entry_set_set(entries_rehashed, entry_set_find_slot(entries_rehashed, entry->hash), entry->hash, entry);
 	}
 
 	// replace old entries with rehashed entries
-	entry_set_free(map_existing->entries, map_existing->key_destructor, map_existing->value_destructor, false);
+	entry_set_free(entries, map_existing->key_destructor, map_existing->value_destructor, false);
 	map_existing->entries = entries_rehashed;
-	map_existing->entry_count = original_entry_count;
 }
 
+void _map_migrate(Map* map, size_t slots) {
+	if (map->growing != NULL) {
+		// clearing a slot is far cheaper than moving one, so a step clears a group for each slot it would move
+		size_t cleared = slots < SIZE_MAX / ENTRY_SET_GROUP_WIDTH ? slots * ENTRY_SET_GROUP_WIDTH : SIZE_MAX;
+
+		if (!entry_set_prepare(map->growing, cleared)) {
+			return;
+		}
+
+		map->previous = map->entries;
+		map->entries = map->growing;
+		map->growing = NULL;
+		map->migrated = 0;
 
+		if (slots != SIZE_MAX) {
+			return;
+		}
+	}
 
+	EntrySet* previous = map->previous;
 
+	if (previous == NULL) {
+		return;
+	}
 
+	for (size_t i = 0; i < slots && map->migrated < previous->capacity; i++, map->migrated++) {
+		if (previous->data[map->migrated] == NULL) {
+			continue;
+		}
+
+		Entry* entry = entry_set_erase(previous, map->migrated);
+		entry_set_set(map->entries, entry_set_find_slot(map->entries, entry->hash), entry->hash, entry);
+	}
+
+	if (map->migrated == previous->capacity) {
+		entry_set_free(previous, map->key_destructor, map->value_destructor, false);
+		map->previous = NULL;
+		map->migrated = 0;
+	}
+}
+
+// Searches the current table, then the table still being migrated from
+size_t _map_find(Map* map, size_t hash, void* key, EqualityChecker comparator, EntrySet** owner) {
+	*owner = map->entries;
+	size_t index = entry_set_find(map->entries, hash, key, comparator);
+
+	if (index == ENTRY_SET_NOT_FOUND && map->previous != NULL) {
+		*owner = map->previous;
+		index = entry_set_find(map->previous, hash, key, comparator);
+	}
+
+	return index;
+}
+
+bool _map_view_equals(void* view, void* key) {
+	MapView* borrowed = view;
+	return borrowed->comparator(borrowed->key, borrowed->length, key);
+}
+
+size_t _map_hash(Map* map, void* key) {
+	return _map_mix(map, map->key_hasher(key));
+}
+
+// Finalizer from MurmurHash3 so weak user hashes still spread over both the probe index and the tag.
+// The seed goes in first, so which user hashes share a slot depends on a value callers never see
+size_t _map_mix(Map* map, size_t user_hash) {
+	uint64_t hash = (uint64_t) (user_hash ^ map->seed);
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ULL;
+	hash ^= hash >> 33;
+
+	return (size_t) hash;
+}
+
+// Seeds differ between maps of the same process, and only follow from the secret process seed
+size_t _map_seed() {
+	static uint64_t maps_created = 0;
+	uint64_t index = __atomic_fetch_add(&maps_created, 1, __ATOMIC_RELAXED);
+
+	return (size_t) hash_bytes(&index, sizeof(index), hash_seed());
+}
+
+size_t _map_capacity_for(size_t entry_count) {
+	return (size_t) (entry_count / MAP_LOAD_SIZE) + 1;
+}
+
+Allocator* _map_entry_allocator(Map* map) {
+	return map->entry_pool != NULL ? &map->entry_pool->allocator : map->allocator;
+}
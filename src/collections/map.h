@@ -11,27 +11,53 @@
 /**
  * MAP_LOAD_SIZE is used to determine if the map needs to be rehashed.
  *
- * The map will opt to rehash if ((map->entry_count / MAP_LOAD_SIZE) + 1) > entries->capacity
+ * The map will opt to rehash if (entries->count + entries->tombstones + 1) > (entries->capacity * MAP_LOAD_SIZE)
  *
- * If this is set to a smaller value, the map will rehash more often which may provide higher 
- * insert speeds at the cost of memory usage. If this is set to a higher value, the map will rehash
- * left often resulting in lower insert speeds, but less memory usage.
+ * If this is set to a smaller value, the map will rehash more often which provides shorter 
+ * probe sequences at the cost of memory usage. If this is set to a higher value, the map will rehash
+ * less often resulting in longer probe sequences, but less memory usage. It must stay below 1.
  */
 #define MAP_LOAD_SIZE 0.75
 #endif
 
+#ifndef MAP_REHASH_STEP
+
+/**
+ * MAP_REHASH_STEP is the number of old table slots moved, or of new table slot groups cleared,
+ * per insert, lookup or removal while a map with incremental rehashing enabled is growing.
+ *
+ * A larger value finishes growth sooner and frees the old table earlier, while a smaller
+ * value keeps the worst case cost of a single operation lower.
+ */
+#define MAP_REHASH_STEP 64
+#endif
+
 /**
  * Map defines a hash map with a dynamically allocated void pointer
  * for both key and value types. Destructors, duplicators, comparators,
  * and hashers must be used to allow for the map to allocate, deallocate
  * and compare data at will. 
  *
- * Member field "entries" contains fields of type "LinkedList*" which itself
- * contains fields of type "Entry*" which holds the passed key and value pairs.
+ * Member field "entries" is an open addressing table of "Entry*" which holds the
+ * passed key and value pairs. Empty and deleted slots are null, so traversal should
+ * cover "entries->capacity" slots and skip nulls.
+ *
+ * Entries are never moved in memory once inserted, so an "Entry*" returned by the map
+ * stays valid until its key is removed or replaced.
+ *
+ * With "incremental" set, no single operation does work proportional to the size of the map.
+ * Growth allocates the larger table as "growing" without initializing it, and later operations
+ * clear its slots, MAP_REHASH_STEP groups at a time, while the current table keeps taking entries.
+ * Once "growing" is cleared it becomes "entries", and the old table becomes "previous" until
+ * later operations move its entries over, MAP_REHASH_STEP slots at a time.
+ * "migrated" is the next slot of "previous" to be moved.
+ *
+ * The map, its tables and its entries are allocated through "allocator" (see `map_new_with()`).
+ * If "entry_pool" is non-null, entries are taken from and released to that pool instead.
  *
- * Important: "entry_count" is the number of total entries, even with matching 
- * hash values. "entries->count" should be used if any traversing of the
- * entries entry set is done
+ * "seed" is drawn at random for each map and mixed into every key hash before it picks a slot,
+ * so keys crafted to share slots in one map spread out in any other. Keys whose hashes are fully
+ * equal still collide, which only a keyed hasher such as `string_hash_keyed()` prevents.
  */
 typedef struct {
 	EntrySet* entries;
@@ -42,9 +68,16 @@ typedef struct {
 	Duplicator key_duplicator;
 	Destructor value_destructor;
 	Duplicator value_duplicator;
+	EntrySet* previous;
+	EntrySet* growing;
+	size_t migrated;
+	bool incremental;
+	Pool* entry_pool;
+	Allocator* allocator;
+	size_t seed;
 } Map;
 
-#define DEFAULT_MAP { NULL, 0, NULL, NULL, NULL, NULL, NULL, NULL }
+#define DEFAULT_MAP { NULL, 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, 0, false, NULL, NULL, 0 }
 OPTION_TYPE(Map, Map, map, DEFAULT_MAP)
 
 
@@ -67,9 +100,6 @@ OPTION_TYPE(Map, Map, map, DEFAULT_MAP)
     static inline void map_##type_name##_insert(Map* map, key_type* key, value_type* value) { \
         map_insert(map, (void*) key, (void*) value); \
     } \
-    static inline void entry_set_##type_name##_add(EntrySet* entries, key_type* element) { \
-        entry_set_add(entries, (void*) element); \
-    } \
     static inline Entry* entry_##type_name##_new(key_type* key, value_type* value) { \
         return entry_new((void*) key, (void*) value); \
     } \
@@ -108,6 +138,21 @@ Map* map_new(
 		Duplicator value_duplicator
 	);
 
+/**
+ * Creates a new map like `map_new()` whose struct, tables and entries are allocated
+ * through the given allocator. Keys and values are still managed by the destructors and duplicators.
+ */
+Map* map_new_with(
+		size_t initial_capacity,
+		Hasher hasher,
+		EqualityChecker key_comparator,
+		Destructor key_destructor,
+		Destructor value_destructor,
+		Duplicator key_duplicator,
+		Duplicator value_duplicator,
+		Allocator* allocator
+	);
+
 /**
  * Returns a deep clone of the given map
  */
@@ -118,6 +163,27 @@ Map* map_clone(Map* map);
  */
 void map_free(Map* map);
 
+/**
+ * Makes the map take its entries from the given pool, so inserting and removing keys recycles
+ * entry memory in contiguous slabs instead of going through malloc and free for each entry.
+ * The map does not own the pool, so one pool can be shared by many maps.
+ * The pool must hold objects of at least `sizeof(Entry)` bytes and the map must be empty.
+ */
+void map_set_entry_pool(Map* map, Pool* pool);
+
+/**
+ * Frees an entry returned by `map_remove()`, releasing it to the map's entry pool if it has one
+ */
+void map_entry_free(Map* map, Entry* entry);
+
+/**
+ * Enables or disables incremental rehashing for the given map.
+ * When enabled, growing the map no longer moves every entry inside a single insert,
+ * which keeps the latency of each operation flat at the cost of briefly keeping two tables.
+ * Disabling it finishes any growth that is still in progress.
+ */
+void map_set_incremental_rehash(Map* map, bool incremental);
+
 /**
  * Returns the value corresponding to the given key.
  * If no value is found by the given key, null is returned.
@@ -132,8 +198,60 @@ void* map_get_value(Map* map, void* key, bool discard_key);
  */
 Entry* map_get_entry(Map* map, void* key, bool discard_key);
 
+/**
+ * Returns true if an entry exists for the given key.
+ * The `discard_key` parameter can be used to automatically discard the given key.
+ */
+bool map_contains(Map* map, void* key, bool discard_key);
+
+/**
+ * Returns the value corresponding to a borrowed key of the given length.
+ * The hasher must return the same hash as the map's Hasher for an equal stored key,
+ * e.g., `string_hash_cstring()` and `string_equals_cstring()` for a map of String keys.
+ * Nothing is allocated and the key is never freed.
+ * If no value is found by the given key, null is returned.
+ */
+void* map_get_value_view(Map* map, const char* key, size_t length, ViewHasher hasher, ViewEqualityChecker comparator);
+
+/**
+ * Returns the entry corresponding to a borrowed key of the given length.
+ * See `map_get_value_view()` for the requirements of the hasher and comparator.
+ * If no entry is found by the given key, null is returned.
+ */
+Entry* map_get_entry_view(Map* map, const char* key, size_t length, ViewHasher hasher, ViewEqualityChecker comparator);
+
+/**
+ * Returns true if an entry exists for a borrowed key of the given length.
+ * See `map_get_value_view()` for the requirements of the hasher and comparator.
+ */
+bool map_contains_view(Map* map, const char* key, size_t length, ViewHasher hasher, ViewEqualityChecker comparator);
+
+/**
+ * Removes and returns the entry by a borrowed key of the given length.
+ * See `map_get_value_view()` for the requirements of the hasher and comparator.
+ * If no entry is found by the given key, null is returned.
+ */
+Entry* map_remove_view(Map* map, const char* key, size_t length, ViewHasher hasher, ViewEqualityChecker comparator);
+
+/**
+ * Returns the entry for a borrowed key of the given length, or if the key is missing, stores
+ * and returns a new entry whose key and value are null, setting `found` to false.
+ * The key is hashed and probed once for both the lookup and the insert.
+ * See `map_get_value_view()` for the requirements of the hasher and comparator.
+ *
+ * The caller must set the key and value of a new entry before the next operation on the map,
+ * and the key must hash and compare like the borrowed one. The map takes ownership of both.
+ */
+Entry* map_claim_view(Map* map, const char* key, size_t length, ViewHasher hasher, ViewEqualityChecker comparator, bool* found);
+
+/**
+ * Helper function for `map_remove_view()`, but automatically discards the return value
+ */
+void map_delete_view(Map* map, const char* key, size_t length, ViewHasher hasher, ViewEqualityChecker comparator);
+
 /**
  * Removes and returns the entry by the given key.
+ * The removed entry should be freed with `map_entry_free()`.
  * If no entry is found by the given key, null is returned.
  * The `discard_key` parameter can be used to automatically discard the given key.
  */
@@ -152,6 +270,36 @@ void map_delete(Map* map, void* key, bool discard_key);
  */
 void map_insert(Map* map, void* key, void* value);
 
+/**
+ * Inserts a key value pair into the map only if the key is missing and returns the stored value slot.
+ * If the key already exists, the given key and value are freed and the stored value is left untouched.
+ * If `inserted` is non-null, it is set to true when the pair was inserted.
+ *
+ * The map takes ownership of the passed key and value parameters.
+ * The returned slot stays valid until the key is removed or replaced.
+ */
+void** map_try_insert(Map* map, void* key, void* value, bool* inserted);
+
+/**
+ * Returns the stored value slot for the given key. If the key is missing, the supplier is
+ * called with the stored key and its non-null result is inserted as the value.
+ * The key is hashed and probed once for both the lookup and the insert.
+ *
+ * The map takes ownership of the passed key and frees it if an entry already exists.
+ * The returned slot stays valid until the key is removed or replaced.
+ */
+void** map_get_or_insert(Map* map, void* key, Supplier supplier);
+
+/**
+ * Inserts a key value pair into the map, or if the key exists, calls the updater with the
+ * stored value and the given value so it can merge the given value into the stored one.
+ * The given key and value are freed after an update. Returns the stored value slot.
+ *
+ * The map takes ownership of the passed key and value parameters.
+ * The returned slot stays valid until the key is removed or replaced.
+ */
+void** map_upsert(Map* map, void* key, void* value, Updater updater);
+
 /**
  * Creates a splice from the given map. Each element is guaranteed to be non-null.
  */
@@ -1,22 +1,60 @@
+#define MEMORY_SUBSYSTEM MEMORY_MAP
 #include "entry.h"
 
+Allocator* _entry_allocator(Pool* pool);
+
 Entry* entry_new(void* key, void* value) {
-	Entry* entry = allocate(sizeof(Entry));
+	return entry_new_with(key, value, allocator_default());
+}
+
+Entry* entry_new_in(void* key, void* value, Pool* pool) {
+	return entry_new_with(key, value, _entry_allocator(pool));
+}
+
+Entry* entry_new_with(void* key, void* value, Allocator* allocator) {
+	Entry* entry = allocator_allocate(allocator, sizeof(Entry));
 	entry->value = value;
 	entry->key = key;
+	entry->hash = 0;
 
 	return entry;
 }
 
 void entry_free(Entry* entry, Destructor key_destructor, Destructor value_destructor) {
+	entry_free_with(entry, key_destructor, value_destructor, allocator_default());
+}
+
+void entry_free_in(Entry* entry, Destructor key_destructor, Destructor value_destructor, Pool* pool) {
+	entry_free_with(entry, key_destructor, value_destructor, _entry_allocator(pool));
+}
+
+void entry_free_with(Entry* entry, Destructor key_destructor, Destructor value_destructor, Allocator* allocator) {
 	key_destructor(entry->key);
 	value_destructor(entry->value);
-	free(entry);
+	allocator_free(allocator, entry, sizeof(Entry));
 }
 
 Entry* entry_clone(Entry* entry, Duplicator key_duplicator, Duplicator value_duplicator) {
-	return entry_new(
+	return entry_clone_with(entry, key_duplicator, value_duplicator, allocator_default());
+}
+
+Entry* entry_clone_in(Entry* entry, Duplicator key_duplicator, Duplicator value_duplicator, Pool* pool) {
+	return entry_clone_with(entry, key_duplicator, value_duplicator, _entry_allocator(pool));
+}
+
+Entry* entry_clone_with(Entry* entry, Duplicator key_duplicator, Duplicator value_duplicator, Allocator* allocator) {
+	Entry* clone = entry_new_with(
 				key_duplicator(entry->key), 
-				value_duplicator(entry->value)
+				value_duplicator(entry->value),
+				allocator
 			);	
+	clone->hash = entry->hash;
+
+	return clone;
+}
+
+// INTERNAL
+
+Allocator* _entry_allocator(Pool* pool) {
+	return pool != NULL ? &pool->allocator : allocator_default();
 }
@@ -3,13 +3,18 @@
 
 #include "../../memory/memory.h"
 #include "../../safety/option.h"
+#include "../../memory/pool.h"
+#include "../../memory/allocator.h"
 
 /**
- * Defines a key value pairing for use in an EntrySet
+ * Defines a key value pairing for use in an EntrySet.
+ * The hash of the key is stored by the EntrySet when the entry is placed, so growing the
+ * table and skipping colliding keys does not call the map's Hasher or EqualityChecker again
  */
 typedef struct {
 	void* key;
 	void* value;
+	size_t hash;
 } Entry;
 
 OPTION_TYPE(Entry*, Entry, entry, NULL)
@@ -18,4 +23,19 @@ Entry* entry_new(void* key, void* value);
 void entry_free(Entry* entry, Destructor key_destructor, Destructor value_destructor);
 Entry* entry_clone(Entry* entry, Duplicator key_duplicator, Duplicator value_duplicator);
 
+/**
+ * Variants of the functions above which take entries from and release them to the given pool.
+ * A null pool uses the heap. The pool must hold objects of at least `sizeof(Entry)` bytes
+ */
+Entry* entry_new_in(void* key, void* value, Pool* pool);
+void entry_free_in(Entry* entry, Destructor key_destructor, Destructor value_destructor, Pool* pool);
+Entry* entry_clone_in(Entry* entry, Duplicator key_duplicator, Duplicator value_duplicator, Pool* pool);
+
+/**
+ * Variants of the functions above which allocate and free entries through the given allocator
+ */
+Entry* entry_new_with(void* key, void* value, Allocator* allocator);
+void entry_free_with(Entry* entry, Destructor key_destructor, Destructor value_destructor, Allocator* allocator);
+Entry* entry_clone_with(Entry* entry, Duplicator key_duplicator, Duplicator value_duplicator, Allocator* allocator);
+
 #endif
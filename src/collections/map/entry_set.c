@@ -1,30 +1,90 @@
+#define MEMORY_SUBSYSTEM MEMORY_MAP
 #include "entry_set.h"
 #include "../../error/error.h"
+#include <string.h>
 
-void _entry_set_try_expand(EntrySet* entries);
-LinkedList* _override_linked_list_clone(LinkedList* list, Duplicator key_duplicator, Duplicator value_duplicator);
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-EntrySet* entry_set_new(size_t capacity) {	
-	EntrySet* entries = allocate(sizeof(EntrySet));
+size_t _entry_set_h1(size_t hash);
+int8_t _entry_set_h2(size_t hash);
+void _entry_set_set_control(EntrySet* entries, size_t index, int8_t control);
+static inline uint32_t _entry_set_match(int8_t* group, int8_t control);
+static inline uint32_t _entry_set_match_available(int8_t* group);
 
-	entries->capacity = capacity;
+EntrySet* entry_set_new(size_t capacity) {
+	return entry_set_new_with(capacity, allocator_default(), allocator_default());
+}
+
+EntrySet* entry_set_new_with(size_t capacity, Allocator* allocator, Allocator* entry_allocator) {
+	EntrySet* entries = entry_set_new_unprepared(capacity, allocator, entry_allocator);
+	entry_set_prepare(entries, SIZE_MAX);
+
+	return entries;
+}
+
+EntrySet* entry_set_new_unprepared(size_t capacity, Allocator* allocator, Allocator* entry_allocator) {
+	ASSERT_NONNULL(allocator);
+	ASSERT_NONNULL(entry_allocator);
+
+	size_t rounded = ENTRY_SET_GROUP_WIDTH;
+	while (rounded < capacity) {
+		rounded *= 2;
+	}
+
+	EntrySet* entries = allocator_allocate(allocator, sizeof(EntrySet));
+
+	entries->capacity = rounded;
 	entries->count = 0;
-	entries->data = callocate(capacity, sizeof(void*));
+	entries->tombstones = 0;
+	entries->prepared = 0;
+	entries->allocator = allocator;
+	entries->entry_allocator = entry_allocator;
+	entries->data = allocator_allocate(allocator, sizeof(Entry*) * rounded);
+	entries->controls = allocator_allocate(allocator, sizeof(int8_t) * (rounded + ENTRY_SET_GROUP_WIDTH));
 
 	return entries;
 }
 
+bool entry_set_prepare(EntrySet* entries, size_t slots) {
+	ASSERT_NONNULL(entries);
+
+	size_t remaining = entries->capacity - entries->prepared;
+	size_t length = slots < remaining ? slots : remaining;
+
+	memset(entries->controls + entries->prepared, ENTRY_SET_EMPTY, length);
+	memset(entries->data + entries->prepared, 0, sizeof(Entry*) * length);
+	entries->prepared += length;
+
+	if (length < remaining) {
+		return false;
+	}
+
+	// the mirrored group after the last slot
+	memset(entries->controls + entries->capacity, ENTRY_SET_EMPTY, ENTRY_SET_GROUP_WIDTH);
+
+	return true;
+}
+
 
 EntrySet* entry_set_clone(EntrySet* entries, Duplicator key_duplicator, Duplicator value_duplicator) {
-	EntrySet* clone_entries = allocate(sizeof(EntrySet));
+	EntrySet* clone_entries = allocator_allocate(entries->allocator, sizeof(EntrySet));
 
 	clone_entries->capacity = entries->capacity;
 	clone_entries->count = entries->count;
+	clone_entries->tombstones = entries->tombstones;
+	clone_entries->prepared = entries->prepared;
+	clone_entries->allocator = entries->allocator;
+	clone_entries->entry_allocator = entries->entry_allocator;
 
-	clone_entries->data = allocate(sizeof(void*) * entries->capacity);
+	clone_entries->controls = allocator_allocate(entries->allocator, sizeof(int8_t) * (entries->capacity + ENTRY_SET_GROUP_WIDTH));
+	memcpy(clone_entries->controls, entries->controls, entries->capacity + ENTRY_SET_GROUP_WIDTH);
+
+	clone_entries->data = allocator_allocate(entries->allocator, sizeof(Entry*) * entries->capacity);
 	for (size_t i = 0; i < entries->capacity; i++) {
 		if (entries->data[i] != NULL) {
-			clone_entries->data[i] = _override_linked_list_clone(entries->data[i], key_duplicator, value_duplicator);
+			clone_entries->data[i] = entry_clone_with(entries->data[i], key_duplicator, value_duplicator, entries->entry_allocator);
 		} else {
 			clone_entries->data[i] = NULL;
 		}
@@ -35,129 +95,187 @@ EntrySet* entry_set_clone(EntrySet* entries, Duplicator key_duplicator, Duplicat
 
 
 void entry_set_free(EntrySet* entries, Destructor key_destructor, Destructor value_destructor, bool should_delete_entry) {
-	for (size_t i = 0; i < entries->capacity; i++) {
-		LinkedList* bucket = entries->data[i];
-
-		if (bucket == NULL) {
-			continue;
-		} 
-
-		Node* temp = bucket->head;
-		Node* free_temp = temp;
-
-		while (temp != NULL) {
-			temp = temp->next;	
-
-			if (should_delete_entry) {
-				entry_free(
-						(Entry*) free_temp->element, 
-						key_destructor, 
-						value_destructor
-					);
-			} else {
-				free(free_temp->element);
+	if (should_delete_entry) {
+		for (size_t i = 0; i < entries->capacity; i++) {
+			if (entries->data[i] != NULL) {
+				entry_free_with(entries->data[i], key_destructor, value_destructor, entries->entry_allocator);
 			}
-
-			free(free_temp);
-			free_temp = temp;
 		}
-		
-		free(bucket);
 	}
 
-	free(entries->data);
-	free(entries);
+	allocator_free(entries->allocator, entries->controls, sizeof(int8_t) * (entries->capacity + ENTRY_SET_GROUP_WIDTH));
+	allocator_free(entries->allocator, entries->data, sizeof(Entry*) * entries->capacity);
+	allocator_free(entries->allocator, entries, sizeof(EntrySet));
 }
 
-LinkedList* entry_set_get(EntrySet* entry_set, size_t index) {
-	return ((LinkedList*) entry_set->data[index]);
+size_t entry_set_find(EntrySet* entries, size_t hash, void* key, EqualityChecker comparator) {
+	return entry_set_find_or_slot(entries, hash, key, comparator, NULL);
 }
 
-bool entry_set_set(EntrySet* entry_set, size_t map_entry_count, size_t index, LinkedList* list, bool should_adjust_capacity) {	
-	bool changed_capacity = false;
+size_t entry_set_find_or_slot(EntrySet* entries, size_t hash, void* key, EqualityChecker comparator, size_t* slot) {
+	size_t mask = entries->capacity - 1;
+	size_t position = _entry_set_h1(hash) & mask;
+	int8_t tag = _entry_set_h2(hash);
+
+	// triangular probing visits every group once when the capacity is a power of two
+	for (size_t stride = ENTRY_SET_GROUP_WIDTH; stride <= entries->capacity + ENTRY_SET_GROUP_WIDTH; stride += ENTRY_SET_GROUP_WIDTH) {
+		int8_t* group = entries->controls + position;
+		uint32_t matches = _entry_set_match(group, tag);
 
-	if (should_adjust_capacity && (((float) map_entry_count / MAP_LOAD_SIZE) + 1) > entry_set->capacity) {
-		changed_capacity = true;	
-		size_t old_capacity = entry_set->capacity;
+		// remember where the key would be inserted so a miss needs no second probe
+		if (slot != NULL && *slot == ENTRY_SET_NOT_FOUND) {
+			uint32_t available = _entry_set_match_available(group);
 
-		if (entry_set->capacity == 0) {
-			entry_set->capacity = 2;
-		} else {	
-			entry_set->capacity = entry_set->capacity * 2;
+			if (available != 0) {
+				*slot = (position + __builtin_ctz(available)) & mask;
+			}
 		}
 
-		entry_set->data = reallocate(entry_set->data, sizeof(void*) * entry_set->capacity);
+		while (matches != 0) {
+			size_t index = (position + __builtin_ctz(matches)) & mask;
+			Entry* entry = entries->data[index];
+
+			// only keys with the same full hash can be equal
+			if (entry->hash == hash && comparator(key, entry->key)) {
+				return index;
+			}
+
+			matches &= matches - 1;
+		}
 
-		// Set unitialized new memory to null pointers
-		for (size_t i = old_capacity; i < entry_set->capacity; i++) {
-			entry_set->data[i] = NULL; 
+		// an empty slot ends the probe sequence as the key would have been placed there
+		if (_entry_set_match(group, ENTRY_SET_EMPTY) != 0) {
+			return ENTRY_SET_NOT_FOUND;
 		}
+
+		position = (position + stride) & mask;
 	}
-	
-	entry_set->data[index] = list;
-	entry_set->count++;
 
-	return changed_capacity;
+	return ENTRY_SET_NOT_FOUND;
 }
 
-void entry_set_add(EntrySet* entries, void* element) {
+size_t entry_set_find_slot(EntrySet* entries, size_t hash) {
+	size_t mask = entries->capacity - 1;
+	size_t position = _entry_set_h1(hash) & mask;
+
+	for (size_t stride = ENTRY_SET_GROUP_WIDTH; ; stride += ENTRY_SET_GROUP_WIDTH) {
+		uint32_t available = _entry_set_match_available(entries->controls + position);
+
+		if (available != 0) {
+			return (position + __builtin_ctz(available)) & mask;
+		}
+
+		position = (position + stride) & mask;
+	}
+}
+
+void entry_set_set(EntrySet* entries, size_t index, size_t hash, Entry* entry) {
 	ASSERT_NONNULL(entries);
-	ASSERT_NONNULL(element);
+	ASSERT_NONNULL(entry);
+	ASSERT_VALID_BOUNDS(entries, (int) index, (int) entries->capacity);
+
+	if (entries->controls[index] == ENTRY_SET_DELETED) {
+		entries->tombstones--;
+	}
 
-	_entry_set_try_expand(entries);
-	entries->data[entries->count] = element;
+	_entry_set_set_control(entries, index, _entry_set_h2(hash));
+	entry->hash = hash;
+	entries->data[index] = entry;
 	entries->count++;
 }
 
-// OVERRIDES
+Entry* entry_set_erase(EntrySet* entries, size_t index) {
+	ASSERT_NONNULL(entries);
+	ASSERT_VALID_BOUNDS(entries, (int) index, (int) entries->capacity);
+
+	Entry* entry = entries->data[index];
+	ASSERT_NONNULL(entry);
 
-LinkedList* _override_linked_list_clone(LinkedList* list, Duplicator key_duplicator, Duplicator value_duplicator) {
-	LinkedList* list_clone = allocate(sizeof(LinkedList));
-	list_clone->destructor = list->destructor;
-	list_clone->duplicator = list->duplicator;
-	list_clone->count= list->count;
+	size_t mask = entries->capacity - 1;
+	uint32_t empty_after = _entry_set_match(entries->controls + index, ENTRY_SET_EMPTY);
+	uint32_t empty_before = _entry_set_match(entries->controls + ((index - ENTRY_SET_GROUP_WIDTH) & mask), ENTRY_SET_EMPTY);
 
-	if (linked_list_headless(list)) {
-		return list_clone;	
-	}	
+	// If no full window of ENTRY_SET_GROUP_WIDTH slots ever covered this slot, a probe could
+	// not have passed over it, so it can become empty instead of leaving a tombstone
+	bool was_never_full = empty_after != 0 && empty_before != 0
+		&& (size_t) (__builtin_ctz(empty_after) + __builtin_clz(empty_before) - (32 - ENTRY_SET_GROUP_WIDTH)) < ENTRY_SET_GROUP_WIDTH;
 
-	list_clone->head = allocate(sizeof(Node));
-	list_clone->head->element = entry_clone(
-				(Entry*) list->head->element,
-				key_duplicator, 
-				value_duplicator
-			);
+	if (was_never_full) {
+		_entry_set_set_control(entries, index, ENTRY_SET_EMPTY);
+	} else {
+		_entry_set_set_control(entries, index, ENTRY_SET_DELETED);
+		entries->tombstones++;
+	}
 
-	Node* temp_node = list->head;
-	Node* temp_clone = list_clone->head;
+	entries->data[index] = NULL;
+	entries->count--;
 
-	while (temp_node->next != NULL) {
-		temp_node = temp_node->next;	
+	return entry;
+}
 
-		temp_clone->next = linked_node_new(entry_clone(
-					(Entry*) list->head->element,
-					key_duplicator, 
-					value_duplicator
-				), NULL);
+Entry* entry_set_get(EntrySet* entries, size_t index) {
+	ASSERT_NONNULL(entries);
+	ASSERT_VALID_BOUNDS(entries, (int) index, (int) entries->capacity);
 
-		temp_clone = temp_clone->next;
-	}
+	return entries->data[index];
+}
 
-	return list_clone;
+bool entry_set_needs_growth(EntrySet* entries) {
+	return (float) (entries->count + entries->tombstones + 1) > entries->capacity * MAP_LOAD_SIZE;
 }
 
 // INTERNAL
 
-void _entry_set_try_expand(EntrySet* entries) {
-	if (entries->count + 1 < entries->capacity) {
-		return;	
+size_t _entry_set_h1(size_t hash) {
+	return hash >> 7;
+}
+
+int8_t _entry_set_h2(size_t hash) {
+	return (int8_t) (hash & 0x7F);
+}
+
+void _entry_set_set_control(EntrySet* entries, size_t index, int8_t control) {
+	entries->controls[index] = control;
+
+	// keep the mirrored group in sync for loads that run past the end
+	if (index < ENTRY_SET_GROUP_WIDTH) {
+		entries->controls[entries->capacity + index] = control;
+	}
+}
+
+#if defined(__SSE2__)
+
+static inline uint32_t _entry_set_match(int8_t* group, int8_t control) {
+	__m128i controls = _mm_loadu_si128((const __m128i*) group);
+	return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(control), controls));
+}
+
+static inline uint32_t _entry_set_match_available(int8_t* group) {
+	// empty and deleted are the only controls with the high bit set
+	__m128i controls = _mm_loadu_si128((const __m128i*) group);
+	return (uint32_t) _mm_movemask_epi8(controls);
+}
+
+#else
+
+static inline uint32_t _entry_set_match(int8_t* group, int8_t control) {
+	uint32_t matches = 0;
+
+	for (size_t i = 0; i < ENTRY_SET_GROUP_WIDTH; i++) {
+		matches |= (uint32_t) (group[i] == control) << i;
 	}
-	
-	if (entries->capacity == 0) {
-		entries->capacity = 2;
-	} else {	
-		entries->capacity = entries->capacity * 2;
+
+	return matches;
+}
+
+static inline uint32_t _entry_set_match_available(int8_t* group) {
+	uint32_t matches = 0;
+
+	for (size_t i = 0; i < ENTRY_SET_GROUP_WIDTH; i++) {
+		matches |= (uint32_t) (group[i] < 0) << i;
 	}
 
-	entries->data = reallocate(entries->data, sizeof(void*) * entries->capacity);
+	return matches;
 }
+
+#endif
@@ -1,33 +1,85 @@
 #ifndef NORMALC_ENTRY_SET_H
 #define NORMALC_ENTRY_SET_H
 
-#include "../linked_list.h"
 #include "entry.h"
+#include <stdint.h>
 
 #ifndef MAP_LOAD_SIZE
 #define MAP_LOAD_SIZE 0.75
 #endif
 
+/**
+ * Number of control bytes inspected at once while probing.
+ * With SSE2 a group is compared in a single instruction, otherwise a portable loop is used.
+ */
+#define ENTRY_SET_GROUP_WIDTH 16
+
+/**
+ * Control byte values. A full slot stores the low 7 bits of its hash (0 to 127),
+ * empty and deleted slots have the high bit set.
+ */
+#define ENTRY_SET_EMPTY ((int8_t) -128)
+#define ENTRY_SET_DELETED ((int8_t) -2)
+
+/**
+ * Returned by `entry_set_find()` if no entry matches
+ */
+#define ENTRY_SET_NOT_FOUND SIZE_MAX
+
 /**
  * EntrySet represents the underlying data structure for a HashMap's key value pairs.
- * Each linked list pointer contains one or more `Entry`. 
+ * It is an open addressing table where each slot has one control byte and one `Entry*`.
  *
- * The count supplied by the entry set does not necessarily represent the amount of values in the 
- * set as there may be keys with duplicate hash codes 
+ * Lookups scan the control bytes a group at a time for the 7 bit hash tag of the key,
+ * so the `Entry` itself is only read for probable matches.
+ *
+ * The control array holds `capacity + ENTRY_SET_GROUP_WIDTH` bytes. The trailing bytes
+ * mirror the first group so a group can be loaded at any index without wrapping.
+ * The capacity is always a power of two and never smaller than ENTRY_SET_GROUP_WIDTH.
+ *
+ * The tables and the set itself are allocated through "allocator", while cloned and freed
+ * entries go through "entry_allocator".
+ *
+ * "prepared" is the number of slots cleared so far. It only falls short of "capacity" for a set
+ * from `entry_set_new_unprepared()`, which must not be used until `entry_set_prepare()` has
+ * cleared every slot.
  */
 typedef struct {
-	LinkedList** data;
+	int8_t* controls;
+	Entry** data;
 	size_t count;
+	size_t tombstones;
 	size_t capacity;
+	size_t prepared;
+	Allocator* allocator;
+	Allocator* entry_allocator;
 } EntrySet;
 
 OPTION_TYPE(EntrySet*, EntrySet, entry_set, NULL)
 
 /**
- * Returns a new entry set with the given initial capacity.
+ * Returns a new entry set with at least the given number of slots.
  */
 EntrySet* entry_set_new(size_t capacity);
 
+/**
+ * Returns a new entry set with at least the given number of slots whose tables are allocated
+ * through "allocator" and whose entries are cloned and freed through "entry_allocator".
+ */
+EntrySet* entry_set_new_with(size_t capacity, Allocator* allocator, Allocator* entry_allocator);
+
+/**
+ * Same as `entry_set_new_with()`, but the tables are left uninitialized for `entry_set_prepare()`
+ * to clear a slice at a time, so creating even a large set costs no pass over its tables.
+ */
+EntrySet* entry_set_new_unprepared(size_t capacity, Allocator* allocator, Allocator* entry_allocator);
+
+/**
+ * Marks up to the given number of slots of an unprepared set as empty.
+ * Returns true once every slot is empty and the set is ready for use
+ */
+bool entry_set_prepare(EntrySet* entries, size_t slots);
+
 /**
  * Returns a clone of an entry set given duplicators for both the key and value of each entry
  */
@@ -35,25 +87,48 @@ EntrySet* entry_set_clone(EntrySet* entries, Duplicator key_duplicator, Duplicat
 
 /**
  * Frees all entries from the given entry set.
- * If should_delete_entry is false, only the pointer is freed while the underlying data is left alone
+ * If should_delete_entry is false, only the table is freed while the entries are left alone
  */
 void entry_set_free(EntrySet* entries, Destructor key_destructor, Destructor value_destructor, bool should_delete_entry);
 
 /**
- * Adds the given element to the entry set and takes ownership of it
+ * Returns the index of the entry whose key matches the given key and hash.
+ * The comparator is only called for entries with an equal cached hash, with
+ * the given key first and the stored key second.
+ * Returns ENTRY_SET_NOT_FOUND if no entry matches
+ */
+size_t entry_set_find(EntrySet* entries, size_t hash, void* key, EqualityChecker comparator);
+
+/**
+ * Same as `entry_set_find()`, but if no entry matches, `slot` is set to the first empty or
+ * deleted slot of the probe sequence. `slot` must be initialized to ENTRY_SET_NOT_FOUND
+ */
+size_t entry_set_find_or_slot(EntrySet* entries, size_t hash, void* key, EqualityChecker comparator, size_t* slot);
+
+/**
+ * Returns the index of the first empty or deleted slot in the probe sequence of the given hash
+ */
+size_t entry_set_find_slot(EntrySet* entries, size_t hash);
+
+/**
+ * Stores the entry at the given slot, which should come from `entry_set_find_slot()`.
+ * The given hash is cached in the entry and the entry set takes ownership of the entry
+ */
+void entry_set_set(EntrySet* entries, size_t index, size_t hash, Entry* entry);
+
+/**
+ * Removes and returns the entry at the given slot
  */
-void entry_set_add(EntrySet* entries, void* element);
+Entry* entry_set_erase(EntrySet* entries, size_t index);
 
 /**
- * Sets a given entry list into an entry set at the given index.
- * If should_adjust_capacity is true, an attempt to resize the entry_set will be made.
+ * Returns the entry at the given slot or null if the slot is empty or deleted
  */
-bool entry_set_set(EntrySet* entry_set, size_t map_entry_count, size_t index, LinkedList* list, bool should_adjust_capacity);
+Entry* entry_set_get(EntrySet* entries, size_t index);
 
 /**
- * Returns a list of entries from the given entry set.
- * If there is not more than 1 entry by the entry's key, this list will be of size 1.
+ * Returns true if another entry would exceed the MAP_LOAD_SIZE of the entry set
  */
-LinkedList* entry_set_get(EntrySet* entry_set, size_t index);
+bool entry_set_needs_growth(EntrySet* entries);
 
 #endif
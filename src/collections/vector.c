@@ -1,3 +1,4 @@
+#define MEMORY_SUBSYSTEM MEMORY_VECTOR
 #include "vector.h"
 #include "../memory/memory.h"
 #include "../error/error.h"
@@ -6,16 +7,27 @@ void _vector_try_expand(Vector* vector);
 void _vector_move_down(Vector* vector, size_t removed);
 
 Vector* vector_new(size_t capacity, Duplicator duplicator, Destructor destructor) {	
+	return vector_new_with(capacity, duplicator, destructor, allocator_default());
+}
+
+Vector* vector_new_in(size_t capacity, Duplicator duplicator, Destructor destructor, Arena* arena) {	
+	ASSERT_NONNULL(arena);
+	return vector_new_with(capacity, duplicator, destructor, &arena->allocator);
+}
+
+Vector* vector_new_with(size_t capacity, Duplicator duplicator, Destructor destructor, Allocator* allocator) {	
 	ASSERT_NONNULL(duplicator);
 	ASSERT_NONNULL(destructor);
+	ASSERT_NONNULL(allocator);
 
-	Vector* vector = allocate(sizeof(Vector));
+	Vector* vector = allocator_allocate(allocator, sizeof(Vector));
 
 	vector->capacity = capacity;
 	vector->count = 0;
-	vector->data = allocate(sizeof(void*) * capacity);
+	vector->data = allocator_allocate(allocator, sizeof(void*) * capacity);
 	vector->destructor = destructor;
 	vector->duplicator = duplicator;
+	vector->allocator = allocator;
 
 	return vector;
 }
@@ -23,14 +35,15 @@ Vector* vector_new(size_t capacity, Duplicator duplicator, Destructor destructor
 Vector* vector_clone(Vector* vector) {
 	ASSERT_NONNULL(vector);
 
-	Vector* cloned = allocate(sizeof(Vector));
+	Vector* cloned = allocator_allocate(vector->allocator, sizeof(Vector));
 
 	cloned->capacity = vector->capacity;
 	cloned->count = vector->count;
 	cloned->destructor = vector->destructor;
 	cloned->duplicator = vector->duplicator;
+	cloned->allocator = vector->allocator;
 
-	cloned->data = allocate(sizeof(void*) * vector->capacity);
+	cloned->data = allocator_allocate(vector->allocator, sizeof(void*) * vector->capacity);
 	for (size_t i = 0; i < vector->count; i++) {	
 		cloned->data[i] = vector->duplicator(vector->data[i]);
 	}
@@ -44,8 +57,9 @@ void vector_free(Vector* vector) {
 	for (size_t i = 0; i < vector->count; i++) {
 		vector->destructor(vector->data[i]);
 	}
-	free(vector->data);
-	free(vector);
+
+	allocator_free(vector->allocator, vector->data, sizeof(void*) * vector->capacity);
+	allocator_free(vector->allocator, vector, sizeof(Vector));
 }
 
 void vector_add(Vector* vector, void* element) {
@@ -155,7 +169,7 @@ void* vector_splice_get(VectorSplice* splice, size_t index) {
 
 void vector_splice_free(VectorSplice* splice) {
 	ASSERT_NONNULL(splice);
-	free(splice);
+	deallocate(splice);
 }
 
 void _vector_move_down(Vector* vector, size_t removed) {
@@ -169,6 +183,8 @@ void _vector_try_expand(Vector* vector) {
 	if (vector->count + 1 < vector->capacity) {
 		return;	
 	}
+
+	size_t old_capacity = vector->capacity;
 	
 	if (vector->capacity == 0) {
 		vector->capacity = 2;
@@ -176,7 +192,7 @@ void _vector_try_expand(Vector* vector) {
 		vector->capacity = vector->capacity * 2;
 	}
 
-	vector->data = reallocate(vector->data, sizeof(void*) * vector->capacity);
+	vector->data = allocator_reallocate(vector->allocator, vector->data, sizeof(void*) * old_capacity, sizeof(void*) * vector->capacity);
 }
 
 
@@ -4,6 +4,8 @@
 #include <stdlib.h>
 #include "../safety/option.h"
 #include "../memory/memory.h"
+#include "../memory/arena.h"
+#include "../memory/allocator.h"
 
 /**
  * Vector defines a collection of heap allocated void pointers with a default duplicator 
@@ -11,6 +13,8 @@
  *
  * As opposed to the Array type, vectors should be used for complex objects that require
  * the use of the heap.
+ *
+ * The vector struct and its data are allocated through "allocator" (see `vector_new_with()`)
  */
 typedef struct {
 	void** data;
@@ -18,6 +22,7 @@ typedef struct {
 	size_t capacity;
 	Destructor destructor;
 	Duplicator duplicator;
+	Allocator* allocator;
 } Vector;
 
 /**
@@ -75,7 +80,34 @@ Vector* vector_new(
 		);
 
 /**
- * Returns a deep clone of the given vector without freeing the original
+ * Returns a new vector with the given initial capacity whose struct and data are allocated
+ * through the given allocator. Elements are still managed by the duplicator and destructor.
+ */
+Vector* vector_new_with(
+			size_t capacity,
+			Duplicator duplicator,
+			Destructor destructor,
+			Allocator* allocator
+		);
+
+/**
+ * Returns a new vector with the given initial capacity whose struct and data are pushed
+ * onto the given arena. Growing the vector resizes its data within the arena.
+ *
+ * `vector_free()` still runs the destructor on each element, but the vector's own memory
+ * is only released by resetting or freeing the arena. A destructor_empty can be used for
+ * elements that live in the same arena.
+ */
+Vector* vector_new_in(
+			size_t capacity,
+			Duplicator duplicator,
+			Destructor destructor,
+			Arena* arena
+		);
+
+/**
+ * Returns a deep clone of the given vector without freeing the original.
+ * The clone uses the same allocator as the original
  */
 Vector* vector_clone(Vector* vector);
 
@@ -0,0 +1,221 @@
+#include "hash.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <sys/random.h>
+#endif
+
+static const uint64_t HASH_SECRET[4] = {
+	0x2d358dccaa6c78a5ULL,
+	0x8bb84b93962eacc9ULL,
+	0x4b33a62ed433d4a3ULL,
+	0x4d5a2da51de1aa47ULL,
+};
+
+#define HASH_SIP_ROUNDS 1
+#define HASH_SIP_FINAL_ROUNDS 3
+
+static pthread_once_t hash_once = PTHREAD_ONCE_INIT;
+static uint64_t hash_process_seed;
+static HashKey hash_process_key;
+
+static inline void _hash_multiply(uint64_t* low, uint64_t* high);
+static inline uint64_t _hash_mix(uint64_t first, uint64_t second);
+static inline uint64_t _hash_read8(const uint8_t* bytes);
+static inline uint64_t _hash_read4(const uint8_t* bytes);
+static inline uint64_t _hash_rotate(uint64_t value, int bits);
+void _hash_random(void* bytes, size_t length);
+void _hash_init();
+
+uint64_t hash_bytes(const void* bytes, size_t length, uint64_t seed) {
+	const uint8_t* current = bytes;
+	uint64_t first;
+	uint64_t second;
+
+	seed ^= _hash_mix(seed ^ HASH_SECRET[0], HASH_SECRET[1]);
+
+	if (length <= 16) {
+		if (length >= 4) {
+			// two overlapping reads from each end cover every byte of 4 to 16
+			size_t offset = (length >> 3) << 2;
+			first = (_hash_read4(current) << 32) | _hash_read4(current + offset);
+			second = (_hash_read4(current + length - 4) << 32) | _hash_read4(current + length - 4 - offset);
+		} else if (length > 0) {
+			first = ((uint64_t) current[0] << 16) | ((uint64_t) current[length >> 1] << 8) | current[length - 1];
+			second = 0;
+		} else {
+			first = 0;
+			second = 0;
+		}
+	} else {
+		size_t remaining = length;
+
+		if (remaining > 48) {
+			uint64_t lane1 = seed;
+			uint64_t lane2 = seed;
+
+			do {
+				seed = _hash_mix(_hash_read8(current) ^ HASH_SECRET[1], _hash_read8(current + 8) ^ seed);
+				lane1 = _hash_mix(_hash_read8(current + 16) ^ HASH_SECRET[2], _hash_read8(current + 24) ^ lane1);
+				lane2 = _hash_mix(_hash_read8(current + 32) ^ HASH_SECRET[3], _hash_read8(current + 40) ^ lane2);
+				current += 48;
+				remaining -= 48;
+			} while (remaining > 48);
+
+			seed ^= lane1 ^ lane2;
+		}
+
+		while (remaining > 16) {
+			seed = _hash_mix(_hash_read8(current) ^ HASH_SECRET[1], _hash_read8(current + 8) ^ seed);
+			current += 16;
+			remaining -= 16;
+		}
+
+		// the last 16 bytes may overlap ones already mixed, which is harmless
+		first = _hash_read8(current + remaining - 16);
+		second = _hash_read8(current + remaining - 8);
+	}
+
+	first ^= HASH_SECRET[1];
+	second ^= seed;
+	_hash_multiply(&first, &second);
+
+	return _hash_mix(first ^ HASH_SECRET[0] ^ length, second ^ HASH_SECRET[1]);
+}
+
+uint64_t hash_siphash(const void* bytes, size_t length, const HashKey* key) {
+	const uint8_t* current = bytes;
+	const uint8_t* end = current + (length & ~(size_t) 7);
+	uint64_t v0 = key->k0 ^ 0x736f6d6570736575ULL;
+	uint64_t v1 = key->k1 ^ 0x646f72616e646f6dULL;
+	uint64_t v2 = key->k0 ^ 0x6c7967656e657261ULL;
+	uint64_t v3 = key->k1 ^ 0x7465646279746573ULL;
+
+#define HASH_SIP_ROUND \
+	do { \
+		v0 += v1; v1 = _hash_rotate(v1, 13); v1 ^= v0; v0 = _hash_rotate(v0, 32); \
+		v2 += v3; v3 = _hash_rotate(v3, 16); v3 ^= v2; \
+		v0 += v3; v3 = _hash_rotate(v3, 21); v3 ^= v0; \
+		v2 += v1; v1 = _hash_rotate(v1, 17); v1 ^= v2; v2 = _hash_rotate(v2, 32); \
+	} while (0)
+
+	for (; current < end; current += 8) {
+		uint64_t word = _hash_read8(current);
+		v3 ^= word;
+
+		for (int i = 0; i < HASH_SIP_ROUNDS; i++) {
+			HASH_SIP_ROUND;
+		}
+
+		v0 ^= word;
+	}
+
+	// the final word holds the leftover bytes and the length in its top byte
+	uint64_t last = (uint64_t) length << 56;
+
+	for (size_t i = 0; i < (length & 7); i++) {
+		last |= (uint64_t) current[i] << (8 * i);
+	}
+
+	v3 ^= last;
+
+	for (int i = 0; i < HASH_SIP_ROUNDS; i++) {
+		HASH_SIP_ROUND;
+	}
+
+	v0 ^= last;
+	v2 ^= 0xff;
+
+	for (int i = 0; i < HASH_SIP_FINAL_ROUNDS; i++) {
+		HASH_SIP_ROUND;
+	}
+
+#undef HASH_SIP_ROUND
+
+	return v0 ^ v1 ^ v2 ^ v3;
+}
+
+uint64_t hash_seed() {
+	pthread_once(&hash_once, _hash_init);
+	return hash_process_seed;
+}
+
+const HashKey* hash_key() {
+	pthread_once(&hash_once, _hash_init);
+	return &hash_process_key;
+}
+
+HashKey hash_key_random() {
+	HashKey key;
+	_hash_random(&key, sizeof(key));
+	return key;
+}
+
+// INTERNAL
+
+void _hash_init() {
+	_hash_random(&hash_process_seed, sizeof(hash_process_seed));
+	hash_process_key = hash_key_random();
+}
+
+// Fills the bytes from the kernel, falling back to the clock and addresses only if it has no entropy to give
+void _hash_random(void* bytes, size_t length) {
+#ifdef __linux__
+	if (getrandom(bytes, length, 0) == (ssize_t) length) {
+		return;
+	}
+#endif
+
+	FILE* urandom = fopen("/dev/urandom", "rb");
+
+	if (urandom != NULL) {
+		size_t read = fread(bytes, 1, length, urandom);
+		fclose(urandom);
+
+		if (read == length) {
+			return;
+		}
+	}
+
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	uint64_t state = (uint64_t) now.tv_nsec ^ ((uint64_t) now.tv_sec << 30) ^ (uint64_t) (uintptr_t) bytes;
+
+	for (size_t i = 0; i < length; i++) {
+		state = hash_bytes(&state, sizeof(state), i);
+		((uint8_t*) bytes)[i] = (uint8_t) state;
+	}
+}
+
+static inline uint64_t _hash_rotate(uint64_t value, int bits) {
+	return (value << bits) | (value >> (64 - bits));
+}
+
+// The product is folded back into its inputs rather than replacing them. Otherwise an input that
+// cancels a public constant multiplies the state by zero, and keys built that way collide for any seed
+static inline void _hash_multiply(uint64_t* low, uint64_t* high) {
+	__uint128_t product = (__uint128_t) *low * *high;
+	*low ^= (uint64_t) product;
+	*high ^= (uint64_t) (product >> 64);
+}
+
+// Folds the full 128-bit product, so no input bit is lost to truncation
+static inline uint64_t _hash_mix(uint64_t first, uint64_t second) {
+	_hash_multiply(&first, &second);
+	return first ^ second;
+}
+
+static inline uint64_t _hash_read8(const uint8_t* bytes) {
+	uint64_t value;
+	memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+static inline uint64_t _hash_read4(const uint8_t* bytes) {
+	uint32_t value;
+	memcpy(&value, bytes, sizeof(value));
+	return value;
+}
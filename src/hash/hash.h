@@ -0,0 +1,52 @@
+#ifndef NORMALC_HASH_H
+#define NORMALC_HASH_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * HashKey is the 128-bit secret key of `hash_siphash()`
+ */
+typedef struct {
+	uint64_t k0;
+	uint64_t k1;
+} HashKey;
+
+/**
+ * Returns a 64-bit hash of the given bytes. Different seeds give independent hashes of the same bytes.
+ *
+ * This is wyhash: inputs of up to 16 bytes take a single 64x64 to 128-bit multiply, and
+ * longer inputs are consumed 48 bytes per step on three independent lanes, so every bit of
+ * the result depends on every input bit and the low bits are as good as the high ones.
+ *
+ * Each product is folded back into its inputs, so the seed survives every step and colliding
+ * inputs cannot be built without knowing it. It is still built for speed, not secrecy, so keys
+ * chosen by an untrusted party are safest hashed with `hash_siphash()`.
+ */
+uint64_t hash_bytes(const void* bytes, size_t length, uint64_t seed);
+
+/**
+ * Returns the keyed SipHash-1-3 of the given bytes. Without the key, finding inputs that
+ * collide is no easier than guessing, so tables hashed with a secret key keep short probe
+ * sequences even when every key is chosen by an attacker. It is about three times slower
+ * than `hash_bytes()` on short keys and five times slower on long inputs.
+ */
+uint64_t hash_siphash(const void* bytes, size_t length, const HashKey* key);
+
+/**
+ * Returns the seed of the built-in hashers such as `string_hash()`. It is drawn from the
+ * system random source once per process, so hashes differ between runs and must never be stored.
+ */
+uint64_t hash_seed();
+
+/**
+ * Returns the key of the built-in keyed hashers such as `string_hash_keyed()`, drawn once per process
+ */
+const HashKey* hash_key();
+
+/**
+ * Returns a new key drawn from the system random source
+ */
+HashKey hash_key_random();
+
+#endif
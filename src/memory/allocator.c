@@ -0,0 +1,75 @@
+#include "allocator.h"
+#include "../error/error.h"
+
+void* _allocator_default_allocate(void* context, size_t size);
+void* _allocator_default_reallocate(void* context, void* pointer, size_t old_size, size_t new_size);
+void _allocator_default_free(void* context, void* pointer, size_t size);
+
+static Allocator ALLOCATOR_DEFAULT = {
+	_allocator_default_allocate,
+	_allocator_default_reallocate,
+	_allocator_default_free,
+	NULL
+};
+
+Allocator* allocator_default() {
+	return &ALLOCATOR_DEFAULT;
+}
+
+void* (allocator_allocate)(Allocator* allocator, size_t size) {
+	ASSERT_NONNULL(allocator);
+
+	void* pointer = allocator->allocate(allocator->context, size);
+
+	if (!pointer) {
+		printf("Failed to allocate variable of size %zu", size);
+		exit(EXIT_FAILURE);
+	}
+
+	return pointer;
+}
+
+void* allocator_reallocate(Allocator* allocator, void* pointer, size_t old_size, size_t new_size) {
+	ASSERT_NONNULL(allocator);
+
+	void* resized = allocator->reallocate(allocator->context, pointer, old_size, new_size);
+
+	if (!resized) {
+		printf("Failed to realloc variable of size %zu", new_size);
+		exit(EXIT_FAILURE);
+	}
+
+	return resized;
+}
+
+#ifdef NORMALC_MEMORY_STATS
+void* _allocator_allocate_scoped(Allocator* allocator, size_t size, MemorySubsystem subsystem) {
+	MEMORY_SCOPE_BEGIN(subsystem);
+	void* pointer = (allocator_allocate)(allocator, size);
+	MEMORY_SCOPE_END();
+
+	return pointer;
+}
+#endif
+
+void allocator_free(Allocator* allocator, void* pointer, size_t size) {
+	ASSERT_NONNULL(allocator);
+
+	if (pointer != NULL) {
+		allocator->free(allocator->context, pointer, size);
+	}
+}
+
+// INTERNAL
+
+void* _allocator_default_allocate(__attribute__ ((unused)) void* context, size_t size) {
+	return allocate(size);
+}
+
+void* _allocator_default_reallocate(__attribute__ ((unused)) void* context, void* pointer, __attribute__ ((unused)) size_t old_size, size_t new_size) {
+	return reallocate(pointer, new_size);
+}
+
+void _allocator_default_free(__attribute__ ((unused)) void* context, void* pointer, __attribute__ ((unused)) size_t size) {
+	deallocate(pointer);
+}
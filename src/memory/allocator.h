@@ -0,0 +1,48 @@
+#ifndef NORMALC_ALLOCATOR_H
+#define NORMALC_ALLOCATOR_H
+
+#include "memory.h"
+
+/**
+ * Allocator defines a table of allocation functions plus an opaque context passed to each of them.
+ * Containers created with a `_with` constructor route every allocation of their own memory
+ * through their allocator, so a map or vector can live in an arena, a pool, or a custom heap.
+ *
+ * Sizes are always passed back to `reallocate` and `free`, so allocators do not need to track them.
+ * `allocate` and `reallocate` may return null, which exits the system like `allocate()` does.
+ */
+typedef struct {
+	void* (*allocate) (void* context, size_t size);
+	void* (*reallocate) (void* context, void* pointer, size_t old_size, size_t new_size);
+	void (*free) (void* context, void* pointer, size_t size);
+	void* context;
+} Allocator;
+
+/**
+ * Returns the default allocator, which uses the malloc wrappers from memory.h
+ */
+Allocator* allocator_default();
+
+/**
+ * Allocates `size` bytes from the given allocator
+ */
+void* allocator_allocate(Allocator* allocator, size_t size);
+
+/**
+ * Resizes memory from the given allocator from `old_size` to `new_size` bytes
+ */
+void* allocator_reallocate(Allocator* allocator, void* pointer, size_t old_size, size_t new_size);
+
+/**
+ * Frees `size` bytes of memory from the given allocator
+ */
+void allocator_free(Allocator* allocator, void* pointer, size_t size);
+
+#ifdef NORMALC_MEMORY_STATS
+void* _allocator_allocate_scoped(Allocator* allocator, size_t size, MemorySubsystem subsystem);
+
+// attributes default allocator memory to the subsystem of the caller instead of this file
+#define allocator_allocate(allocator, size) _allocator_allocate_scoped(allocator, size, MEMORY_SUBSYSTEM)
+#endif
+
+#endif
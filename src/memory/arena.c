@@ -0,0 +1,155 @@
+#define MEMORY_SUBSYSTEM MEMORY_ARENA
+#include "arena.h"
+#include "../error/error.h"
+#include <string.h>
+
+ArenaBlock* _arena_block_new(size_t capacity, ArenaBlock* previous);
+size_t _arena_align(size_t size);
+void* _arena_allocate(void* context, size_t size);
+void* _arena_reallocate(void* context, void* pointer, size_t old_size, size_t new_size);
+void _arena_free(void* context, void* pointer, size_t size);
+
+Arena* arena_new(size_t block_size) {
+	ASSERT_INT_GREATER((int) block_size, 0);
+
+	Arena* arena = allocate(sizeof(Arena));
+	arena->block_size = _arena_align(block_size);
+	arena->current = _arena_block_new(arena->block_size, NULL);
+	arena->allocator = (Allocator) {
+		.allocate = _arena_allocate,
+		.reallocate = _arena_reallocate,
+		.free = _arena_free,
+		.context = arena,
+	};
+
+	return arena;
+}
+
+void arena_free(Arena* arena) {
+	ASSERT_NONNULL(arena);
+
+	ArenaBlock* block = arena->current;
+
+	while (block != NULL) {
+		ArenaBlock* previous = block->previous;
+		deallocate(block);
+		block = previous;
+	}
+
+	deallocate(arena);
+}
+
+void* arena_push(Arena* arena, size_t size) {
+	ASSERT_NONNULL(arena);
+
+	size = _arena_align(size);
+	ArenaBlock* block = arena->current;
+
+	if (block->capacity - block->used < size) {
+		block = _arena_block_new(size > arena->block_size ? size : arena->block_size, block);
+		arena->current = block;
+	}
+
+	void* pointer = block->data + block->used;
+	block->used += size;
+
+	return pointer;
+}
+
+void* arena_push_zero(Arena* arena, size_t size) {
+	void* pointer = arena_push(arena, size);
+	memset(pointer, 0, size);
+
+	return pointer;
+}
+
+void* arena_resize(Arena* arena, void* pointer, size_t old_size, size_t new_size) {
+	ASSERT_NONNULL(arena);
+
+	if (pointer == NULL) {
+		return arena_push(arena, new_size);
+	}
+
+	ArenaBlock* block = arena->current;
+	old_size = _arena_align(old_size);
+	new_size = _arena_align(new_size);
+
+	// the most recent push can grow or shrink in place
+	if ((char*) pointer + old_size == block->data + block->used
+			&& block->capacity - block->used + old_size >= new_size) {
+		block->used = block->used - old_size + new_size;
+		return pointer;
+	}
+
+	if (new_size <= old_size) {
+		return pointer;
+	}
+
+	void* moved = arena_push(arena, new_size);
+	memcpy(moved, pointer, old_size);
+
+	return moved;
+}
+
+ArenaMark arena_mark(Arena* arena) {
+	ASSERT_NONNULL(arena);
+
+	return (ArenaMark) {
+		.block = arena->current,
+		.used = arena->current->used,
+	};
+}
+
+void arena_reset_to(Arena* arena, ArenaMark mark) {
+	ASSERT_NONNULL(arena);
+	ASSERT_NONNULL(mark.block);
+
+	while (arena->current != mark.block) {
+		ArenaBlock* previous = arena->current->previous;
+
+		// a mark from another arena or an already released block would run off the list
+		ASSERT_NONNULL(previous);
+
+		deallocate(arena->current);
+		arena->current = previous;
+	}
+
+	arena->current->used = mark.used;
+}
+
+void arena_reset(Arena* arena) {
+	ASSERT_NONNULL(arena);
+
+	while (arena->current->previous != NULL) {
+		ArenaBlock* previous = arena->current->previous;
+		deallocate(arena->current);
+		arena->current = previous;
+	}
+
+	arena->current->used = 0;
+}
+
+// INTERNAL
+
+ArenaBlock* _arena_block_new(size_t capacity, ArenaBlock* previous) {
+	ArenaBlock* block = allocate(sizeof(ArenaBlock) + capacity);
+	block->previous = previous;
+	block->capacity = capacity;
+	block->used = 0;
+
+	return block;
+}
+
+size_t _arena_align(size_t size) {
+	return (size + ARENA_ALIGNMENT - 1) & ~((size_t) ARENA_ALIGNMENT - 1);
+}
+
+void* _arena_allocate(void* context, size_t size) {
+	return arena_push(context, size);
+}
+
+void* _arena_reallocate(void* context, void* pointer, size_t old_size, size_t new_size) {
+	return arena_resize(context, pointer, old_size, new_size);
+}
+
+void _arena_free(__attribute__ ((unused)) void* context, __attribute__ ((unused)) void* pointer, __attribute__ ((unused)) size_t size) {}
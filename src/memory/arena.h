@@ -0,0 +1,93 @@
+#ifndef NORMALC_ARENA_H
+#define NORMALC_ARENA_H
+
+#include "memory.h"
+#include "allocator.h"
+
+#ifndef ARENA_ALIGNMENT
+
+/**
+ * ARENA_ALIGNMENT is the alignment of every pointer returned by an arena.
+ * It must be a power of two at least as large as the strictest alignment stored in the arena.
+ */
+#define ARENA_ALIGNMENT 16
+#endif
+
+/**
+ * ArenaBlock defines one heap allocated chunk of an arena.
+ * Blocks are linked from the newest to the oldest
+ */
+typedef struct ArenaBlock {
+	struct ArenaBlock* previous;
+	size_t capacity;
+	size_t used;
+	char data[] __attribute__ ((aligned (ARENA_ALIGNMENT)));
+} ArenaBlock;
+
+/**
+ * Arena defines a bump allocator. Each push hands out the next bytes of the current block
+ * and a new block is allocated when it runs out. Individual pushes are never freed, instead
+ * the whole arena is reset or rolled back to a mark, which releases every push made after it at once.
+ *
+ * "allocator" lets containers created with a `_with` constructor live in the arena.
+ * Its free function does nothing, so their memory is released with the arena.
+ */
+typedef struct {
+	ArenaBlock* current;
+	size_t block_size;
+	Allocator allocator;
+} Arena;
+
+/**
+ * ArenaMark defines a saved position in an arena to be used with `arena_reset_to()`
+ */
+typedef struct {
+	ArenaBlock* block;
+	size_t used;
+} ArenaMark;
+
+/**
+ * Creates a new arena which allocates blocks of at least the given size.
+ * Pushes larger than the block size get a block of their own.
+ */
+Arena* arena_new(size_t block_size);
+
+/**
+ * Frees the arena and every block it allocated
+ */
+void arena_free(Arena* arena);
+
+/**
+ * Returns a pointer to `size` uninitialized bytes aligned to ARENA_ALIGNMENT.
+ * The memory lives until the arena is reset past it or freed
+ */
+void* arena_push(Arena* arena, size_t size);
+
+/**
+ * Same as `arena_push()`, but the returned bytes are zeroed
+ */
+void* arena_push_zero(Arena* arena, size_t size);
+
+/**
+ * Resizes a previous push from `old_size` to `new_size` bytes and returns its new location.
+ * If the pointer is the most recent push and the block has room, it grows in place,
+ * otherwise the contents are copied into a new push
+ */
+void* arena_resize(Arena* arena, void* pointer, size_t old_size, size_t new_size);
+
+/**
+ * Returns the current position of the arena
+ */
+ArenaMark arena_mark(Arena* arena);
+
+/**
+ * Releases every push made after the given mark, freeing the blocks allocated since then
+ */
+void arena_reset_to(Arena* arena, ArenaMark mark);
+
+/**
+ * Releases every push made in the arena. Only the first block is kept for reuse
+ */
+void arena_reset(Arena* arena);
+
+#endif
@@ -0,0 +1,150 @@
+#include "memory.h"
+
+static const char* MEMORY_SUBSYSTEM_NAMES[MEMORY_SUBSYSTEM_COUNT] = {
+	"other",
+	"string",
+	"vector",
+	"array",
+	"list",
+	"map",
+	"io",
+	"path",
+	"arena",
+	"pool",
+};
+
+#ifdef NORMALC_MEMORY_STATS
+
+/**
+ * Header written in front of every instrumented allocation
+ */
+typedef struct {
+	size_t size;
+	size_t subsystem;
+} MemoryHeader;
+
+_Static_assert(sizeof(MemoryHeader) <= MEMORY_STATS_HEADER, "memory header does not fit MEMORY_STATS_HEADER");
+
+static MemoryCounters MEMORY_COUNTERS[MEMORY_SUBSYSTEM_COUNT];
+static MemoryCounters MEMORY_TOTAL;
+static _Thread_local MemorySubsystem MEMORY_SCOPE = MEMORY_OTHER;
+
+void _memory_counters_add(MemoryCounters* counters, size_t size);
+void _memory_counters_remove(MemoryCounters* counters, size_t size);
+void _memory_counters_load(MemoryCounters* counters, MemoryCounters* snapshot);
+
+#endif
+
+MemoryStats normalc_memory_stats() {
+	MemoryStats stats = { 0 };
+
+#ifdef NORMALC_MEMORY_STATS
+	stats.enabled = true;
+	_memory_counters_load(&MEMORY_TOTAL, &stats.total);
+
+	for (size_t i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++) {
+		_memory_counters_load(&MEMORY_COUNTERS[i], &stats.subsystems[i]);
+	}
+#endif
+
+	return stats;
+}
+
+const char* memory_subsystem_name(MemorySubsystem subsystem) {
+	if (subsystem >= MEMORY_SUBSYSTEM_COUNT) {
+		return "unknown";
+	}
+
+	return MEMORY_SUBSYSTEM_NAMES[subsystem];
+}
+
+void memory_stats_print(MemoryStats* stats, FILE* stream) {
+	if (!stats->enabled) {
+		fprintf(stream, "memory stats disabled, build with NORMALC_MEMORY_STATS\n");
+		return;
+	}
+
+	for (size_t i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++) {
+		MemoryCounters* counters = &stats->subsystems[i];
+
+		if (counters->allocations == 0) {
+			continue;
+		}
+
+		fprintf(stream, "%-8s live %10zu B  peak %10zu B  allocations %10zu  frees %10zu\n",
+				MEMORY_SUBSYSTEM_NAMES[i], counters->live_bytes, counters->peak_bytes, counters->allocations, counters->frees);
+	}
+
+	fprintf(stream, "%-8s live %10zu B  peak %10zu B  allocations %10zu  frees %10zu\n",
+			"total", stats->total.live_bytes, stats->total.peak_bytes, stats->total.allocations, stats->total.frees);
+}
+
+#ifdef NORMALC_MEMORY_STATS
+
+void* _memory_stats_track(void* block, size_t size, MemorySubsystem subsystem) {
+	// an enclosing scope claims the allocations of every subsystem it calls into
+	if (MEMORY_SCOPE != MEMORY_OTHER) {
+		subsystem = MEMORY_SCOPE;
+	}
+
+	MemoryHeader* header = block;
+	header->size = size;
+	header->subsystem = subsystem;
+
+	_memory_counters_add(&MEMORY_COUNTERS[subsystem], size);
+	_memory_counters_add(&MEMORY_TOTAL, size);
+
+	return (char*) block + MEMORY_STATS_HEADER;
+}
+
+void* _memory_stats_untrack(void* pointer, MemorySubsystem* subsystem) {
+	MemoryHeader* header = (MemoryHeader*) ((char*) pointer - MEMORY_STATS_HEADER);
+
+	_memory_counters_remove(&MEMORY_COUNTERS[header->subsystem], header->size);
+	_memory_counters_remove(&MEMORY_TOTAL, header->size);
+
+	if (subsystem != NULL) {
+		*subsystem = header->subsystem;
+	}
+
+	return header;
+}
+
+MemorySubsystem _memory_stats_enter(MemorySubsystem subsystem) {
+	MemorySubsystem previous = MEMORY_SCOPE;
+
+	if (previous == MEMORY_OTHER) {
+		MEMORY_SCOPE = subsystem;
+	}
+
+	return previous;
+}
+
+void _memory_stats_leave(MemorySubsystem previous) {
+	MEMORY_SCOPE = previous;
+}
+
+// INTERNAL
+
+// Counters are shared by every thread, so they are only touched with relaxed atomics
+void _memory_counters_add(MemoryCounters* counters, size_t size) {
+	__atomic_fetch_add(&counters->allocations, 1, __ATOMIC_RELAXED);
+	size_t live = __atomic_add_fetch(&counters->live_bytes, size, __ATOMIC_RELAXED);
+	size_t peak = __atomic_load_n(&counters->peak_bytes, __ATOMIC_RELAXED);
+
+	while (live > peak && !__atomic_compare_exchange_n(&counters->peak_bytes, &peak, live, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+void _memory_counters_remove(MemoryCounters* counters, size_t size) {
+	__atomic_fetch_add(&counters->frees, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_sub(&counters->live_bytes, size, __ATOMIC_RELAXED);
+}
+
+void _memory_counters_load(MemoryCounters* counters, MemoryCounters* snapshot) {
+	snapshot->live_bytes = __atomic_load_n(&counters->live_bytes, __ATOMIC_RELAXED);
+	snapshot->peak_bytes = __atomic_load_n(&counters->peak_bytes, __ATOMIC_RELAXED);
+	snapshot->allocations = __atomic_load_n(&counters->allocations, __ATOMIC_RELAXED);
+	snapshot->frees = __atomic_load_n(&counters->frees, __ATOMIC_RELAXED);
+}
+
+#endif
@@ -4,6 +4,96 @@
 #include "stdlib.h"
 #include "stdio.h"
 #include "stdbool.h"
+#include "stdint.h"
+
+/**
+ * MemorySubsystem tags an allocation with the part of the library that made it.
+ * Each source file defines MEMORY_SUBSYSTEM before its first include so the wrappers below
+ * tag its allocations, and anything else is counted as MEMORY_OTHER.
+ */
+typedef enum {
+	MEMORY_OTHER,
+	MEMORY_STRING,
+	MEMORY_VECTOR,
+	MEMORY_ARRAY,
+	MEMORY_LIST,
+	MEMORY_MAP,
+	MEMORY_IO,
+	MEMORY_PATH,
+	MEMORY_ARENA,
+	MEMORY_POOL,
+	MEMORY_SUBSYSTEM_COUNT,
+} MemorySubsystem;
+
+#ifndef MEMORY_SUBSYSTEM
+#define MEMORY_SUBSYSTEM MEMORY_OTHER
+#endif
+
+/**
+ * Counters for the allocations of a single subsystem.
+ * "allocations" and "frees" count calls, while "live_bytes" and "peak_bytes" count requested bytes.
+ * A resize counts as one free and one allocation
+ */
+typedef struct {
+	size_t live_bytes;
+	size_t peak_bytes;
+	size_t allocations;
+	size_t frees;
+} MemoryCounters;
+
+/**
+ * MemoryStats is a snapshot of the allocation counters of the whole library.
+ * Counting is opt-in: unless the library and its users are built with NORMALC_MEMORY_STATS
+ * defined, "enabled" is false and every counter is zero.
+ */
+typedef struct {
+	bool enabled;
+	MemoryCounters total;
+	MemoryCounters subsystems[MEMORY_SUBSYSTEM_COUNT];
+} MemoryStats;
+
+/**
+ * Returns a snapshot of the allocation counters of every subsystem
+ */
+MemoryStats normalc_memory_stats();
+
+/**
+ * Returns the printable name of the given subsystem
+ */
+const char* memory_subsystem_name(MemorySubsystem subsystem);
+
+/**
+ * Prints the non-empty counters of a snapshot to the given stream, one subsystem per line
+ */
+void memory_stats_print(MemoryStats* stats, FILE* stream);
+
+#ifdef NORMALC_MEMORY_STATS
+
+/**
+ * Every instrumented allocation is prefixed by a header holding its size and subsystem,
+ * which keeps the returned pointer aligned to 16 bytes.
+ * Memory from `allocate()` must therefore be released with `deallocate()`, never `free()`.
+ */
+#define MEMORY_STATS_HEADER 16
+
+void* _memory_stats_track(void* block, size_t size, MemorySubsystem subsystem);
+void* _memory_stats_untrack(void* pointer, MemorySubsystem* subsystem);
+MemorySubsystem _memory_stats_enter(MemorySubsystem subsystem);
+void _memory_stats_leave(MemorySubsystem previous);
+
+/**
+ * Attributes every allocation until MEMORY_SCOPE_END() to the given subsystem, so memory an
+ * IO call allocates through strings and vectors is counted as IO. The outermost scope wins
+ */
+#define MEMORY_SCOPE_BEGIN(subsystem) MemorySubsystem _memory_scope = _memory_stats_enter(subsystem)
+#define MEMORY_SCOPE_END() _memory_stats_leave(_memory_scope)
+
+#else
+
+#define MEMORY_SCOPE_BEGIN(subsystem)
+#define MEMORY_SCOPE_END()
+
+#endif
 
 /**
  * Destructor defines a function that takes in an opaque pointer and returns nothing
@@ -21,6 +111,30 @@ typedef void* (*Duplicator) (void*);
  */
 typedef size_t (*Hasher) (void*);
 
+/**
+ * Supplier defines a function that takes in an opaque key pointer and returns a new heap
+ * allocated value for it
+ */
+typedef void* (*Supplier) (void*);
+
+/**
+ * Updater defines a function that takes in a stored opaque pointer and merges the second
+ * opaque pointer into it without taking ownership of either
+ */
+typedef void (*Updater) (void*, void*);
+
+/**
+ * ViewHasher defines a function that takes in a borrowed key of the given length and returns
+ * a size_t hash. It must match the Hasher used for the stored keys it is compared against
+ */
+typedef size_t (*ViewHasher) (const char*, size_t);
+
+/**
+ * ViewEqualityChecker defines a function that takes in a borrowed key of the given length and
+ * a stored opaque pointer and returns true if same, and false if different
+ */
+typedef bool (*ViewEqualityChecker) (const char*, size_t, void*);
+
 /**
  * Comparator defines a function that takes in two opaque pointers of the same time and
  * returns true if same, and false if different
@@ -48,13 +162,21 @@ static void destructor_empty(__attribute__ ((unused)) void* object) {}
  * Wrapper around malloc which exists system and prints debug message on failure
  */
 static void* allocate(size_t size) {
+#ifdef NORMALC_MEMORY_STATS
+	void* pointer = malloc(size + MEMORY_STATS_HEADER);
+#else
 	void* pointer = malloc(size);
+#endif
 	
 	if (!pointer) {
 		printf("Failed to allocate variable of size %zu", size);
 		exit(EXIT_FAILURE);
 	}
 
+#ifdef NORMALC_MEMORY_STATS
+	pointer = _memory_stats_track(pointer, size, MEMORY_SUBSYSTEM);
+#endif
+
 	return pointer;
 }
 
@@ -63,13 +185,25 @@ static void* allocate(size_t size) {
  * Wrapper around calloc which exists system and prints debug message on failure
  */
 static void* callocate(size_t elements, size_t size) {
+#ifdef NORMALC_MEMORY_STATS
+	void* pointer = NULL;
+
+	if (size == 0 || elements <= (SIZE_MAX - MEMORY_STATS_HEADER) / size) {
+		pointer = calloc(1, elements * size + MEMORY_STATS_HEADER);
+	}
+#else
 	void* pointer = calloc(elements, size);
+#endif
 	
 	if (!pointer) {
 		printf("Failed to callocate %zu elements of size %zu", elements, size);
 		exit(EXIT_FAILURE);
 	}
 
+#ifdef NORMALC_MEMORY_STATS
+	pointer = _memory_stats_track(pointer, elements * size, MEMORY_SUBSYSTEM);
+#endif
+
 	return pointer;
 }
 
@@ -77,14 +211,44 @@ static void* callocate(size_t elements, size_t size) {
  * Wrapper around realloc which exists system and prints debug message on failure
  */
 static void* reallocate(void* original, size_t size) {
+#ifdef NORMALC_MEMORY_STATS
+	if (original == NULL) {
+		return allocate(size);
+	}
+
+	// the resized block keeps the subsystem of the original allocation
+	MemorySubsystem subsystem;
+	void* pointer = realloc(_memory_stats_untrack(original, &subsystem), size + MEMORY_STATS_HEADER);
+#else
 	void* pointer = realloc(original, size);
+#endif
 
 	if (!pointer) {
 		printf("Failed to realloc variable of size %zu", size);
 		exit(EXIT_FAILURE);
 	}
 
+#ifdef NORMALC_MEMORY_STATS
+	pointer = _memory_stats_track(pointer, size, subsystem);
+#endif
+
 	return pointer;
 }
 
+/**
+ * Wrapper around free for memory from `allocate()`, `callocate()` and `reallocate()`.
+ * Null pointers are ignored
+ */
+static void deallocate(void* pointer) {
+#ifdef NORMALC_MEMORY_STATS
+	if (pointer == NULL) {
+		return;
+	}
+
+	pointer = _memory_stats_untrack(pointer, NULL);
+#endif
+
+	free(pointer);
+}
+
 #endif
@@ -0,0 +1,113 @@
+#define MEMORY_SUBSYSTEM MEMORY_POOL
+#include "pool.h"
+#include "../error/error.h"
+
+void _pool_add_slab(Pool* pool);
+void _pool_assert_fits(Pool* pool, size_t size);
+void* _pool_allocate(void* context, size_t size);
+void* _pool_reallocate(void* context, void* pointer, size_t old_size, size_t new_size);
+void _pool_free(void* context, void* pointer, size_t size);
+
+Pool* pool_new(size_t object_size, size_t slab_objects) {
+	ASSERT_INT_GREATER((int) object_size, 0);
+	ASSERT_INT_GREATER((int) slab_objects, 0);
+
+	// released objects store the free list link in place
+	if (object_size < sizeof(void*)) {
+		object_size = sizeof(void*);
+	}
+
+	Pool* pool = allocate(sizeof(Pool));
+	pool->object_size = (object_size + POOL_ALIGNMENT - 1) & ~((size_t) POOL_ALIGNMENT - 1);
+	pool->slab_objects = slab_objects;
+	pool->slabs = NULL;
+	pool->available = NULL;
+	pool->cursor = NULL;
+	pool->end = NULL;
+	pool->count = 0;
+	pool->allocator = (Allocator) {
+		.allocate = _pool_allocate,
+		.reallocate = _pool_reallocate,
+		.free = _pool_free,
+		.context = pool,
+	};
+
+	return pool;
+}
+
+void pool_free(Pool* pool) {
+	ASSERT_NONNULL(pool);
+
+	PoolSlab* slab = pool->slabs;
+
+	while (slab != NULL) {
+		PoolSlab* next = slab->next;
+		deallocate(slab);
+		slab = next;
+	}
+
+	deallocate(pool);
+}
+
+void* pool_take(Pool* pool) {
+	ASSERT_NONNULL(pool);
+
+	pool->count++;
+
+	if (pool->available != NULL) {
+		void* object = pool->available;
+		pool->available = *(void**) object;
+		return object;
+	}
+
+	// slabs are carved lazily so untouched objects never fault in
+	if (pool->cursor == pool->end) {
+		_pool_add_slab(pool);
+	}
+
+	void* object = pool->cursor;
+	pool->cursor += pool->object_size;
+
+	return object;
+}
+
+void pool_release(Pool* pool, void* object) {
+	ASSERT_NONNULL(pool);
+	ASSERT_NONNULL(object);
+
+	*(void**) object = pool->available;
+	pool->available = object;
+	pool->count--;
+}
+
+// INTERNAL
+
+void _pool_add_slab(Pool* pool) {
+	PoolSlab* slab = allocate(sizeof(PoolSlab) + pool->object_size * pool->slab_objects);
+	slab->next = pool->slabs;
+	pool->slabs = slab;
+	pool->cursor = slab->data;
+	pool->end = slab->data + pool->object_size * pool->slab_objects;
+}
+
+void _pool_assert_fits(Pool* pool, size_t size) {
+	if (size > pool->object_size) {
+		printf("\nPOOL ERROR: requested %zu bytes from a pool of %zu byte objects\nSee: %s (line %d)\n",
+				size, pool->object_size, __FILE__, __LINE__);
+		exit(EXIT_FAILURE);
+	}
+}
+
+void* _pool_allocate(void* context, size_t size) {
+	_pool_assert_fits(context, size);
+	return pool_take(context);
+}
+
+void* _pool_reallocate(void* context, void* pointer, __attribute__ ((unused)) size_t old_size, size_t new_size) {
+	_pool_assert_fits(context, new_size);
+	return pointer;
+}
+
+void _pool_free(void* context, void* pointer, __attribute__ ((unused)) size_t size) {
+	pool_release(context, pointer);
+}
@@ -0,0 +1,86 @@
+#ifndef NORMALC_POOL_H
+#define NORMALC_POOL_H
+
+#include "memory.h"
+#include "allocator.h"
+#include "../safety/option.h"
+
+#ifndef POOL_ALIGNMENT
+
+/**
+ * POOL_ALIGNMENT is the alignment of every object handed out by a pool.
+ * Object sizes are rounded up to a multiple of it.
+ */
+#define POOL_ALIGNMENT 8
+#endif
+
+/**
+ * PoolSlab defines one contiguous heap allocated run of pool objects.
+ * Slabs are linked from the newest to the oldest
+ */
+typedef struct PoolSlab {
+	struct PoolSlab* next;
+	char data[] __attribute__ ((aligned (POOL_ALIGNMENT)));
+} PoolSlab;
+
+/**
+ * Pool defines an allocator for objects of a single fixed size.
+ * Objects are carved out of slabs holding "slab_objects" objects each, and released objects
+ * are kept on an intrusive free list to be handed out again, so churn reuses the same memory
+ * instead of going through malloc and free.
+ *
+ * Slabs are only returned to the system by `pool_free()`.
+ *
+ * "allocator" hands out pool objects to code that takes an Allocator. Requests larger than
+ * "object_size" exit the system with an error.
+ */
+typedef struct {
+	PoolSlab* slabs;
+	void* available;
+	char* cursor;
+	char* end;
+	size_t object_size;
+	size_t slab_objects;
+	size_t count;
+	Allocator allocator;
+} Pool;
+
+OPTION_TYPE(Pool*, Pool, pool, NULL)
+
+/**
+ * Defines type safe functions for the Pool type
+ */
+#define POOL_SAFE(type, type_name) \
+    static inline Pool* pool_##type_name##_new(size_t slab_objects) { \
+        return pool_new(sizeof(type), slab_objects); \
+    } \
+    static inline type* pool_##type_name##_take(Pool* pool) { \
+        return (type*) pool_take(pool); \
+    } \
+    static inline void pool_##type_name##_release(Pool* pool, type* object) { \
+        pool_release(pool, (void*) object); \
+    } \
+
+/**
+ * Creates a new pool for objects of the given size.
+ * Each slab holds `slab_objects` objects, so a larger value means fewer allocations
+ * at the cost of more memory held by a mostly empty pool.
+ */
+Pool* pool_new(size_t object_size, size_t slab_objects);
+
+/**
+ * Frees the pool and every slab. Objects taken from the pool are invalid afterwards
+ */
+void pool_free(Pool* pool);
+
+/**
+ * Returns an uninitialized object from the pool, reusing a released object if there is one
+ */
+void* pool_take(Pool* pool);
+
+/**
+ * Returns an object taken from this pool so it can be handed out again
+ */
+void pool_release(Pool* pool, void* object);
+
+#endif
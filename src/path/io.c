@@ -1,44 +1,108 @@
+#define MEMORY_SUBSYSTEM MEMORY_IO
 #include "io.h"
 #include "../string/string.h"
 #include "../collections/vector.h"
-#include "../string/string.h"
-#include <normalc/string/string_builder.h>
+#include "../string/string_builder.h"
+#include <errno.h>
+#include <fcntl.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Size of each read from files whose size is not known up front, such as pipes and /proc
+ */
+#define IO_READ_CHUNK (64 * 1024)
+
+/**
+ * Most lines a vector from `io_file_read_n_lines()` is sized for up front
+ */
+#define IO_READ_LINES_CAPACITY 1024
 
 bool _io_read_line(FILE* stream, String** dest);
+bool _io_line_reader_refill(IoLineReader* reader);
+String* _io_read_stream(int descriptor);
+ssize_t _io_read_fully(int descriptor, char* buffer, size_t length);
 
 String* io_file_read(Path* path) {
 	ASSERT_NONNULL(path);
+	MEMORY_SCOPE_BEGIN(MEMORY_IO);
 
-	StringBuilder* builder = string_builder_new();
-	FILE* file = fopen(path->url->buffer, "r");
+	int descriptor = open(path->url->buffer, O_RDONLY | O_CLOEXEC);
+	struct stat info;
 
-	if (!file) {
-		String* blank = string_builder_build(builder);
-		string_builder_free(builder);
-		return blank;
+	if (descriptor < 0 || fstat(descriptor, &info) != 0) {
+		if (descriptor >= 0) {
+			close(descriptor);
+		}
+
+		MEMORY_SCOPE_END();
+		return string_empty();
 	}
 
-	String* line;
-	bool not_eof = false;
+	String* contents;
+
+	if (S_ISREG(info.st_mode) && info.st_size > 0) {
+		contents = string_allocate((size_t) info.st_size);
+		ssize_t read = _io_read_fully(descriptor, contents->buffer, contents->length);
+
+		// a file that shrank since fstat keeps what could still be read
+		contents->length = read > 0 ? (size_t) read : 0;
+		contents->buffer[contents->length] = '\0';
+	} else {
+		contents = _io_read_stream(descriptor);
+	}
+
+	close(descriptor);
+	MEMORY_SCOPE_END();
+
+	return contents;
+}
+
+bool io_file_map(Path* path, StringView* view) {
+	ASSERT_NONNULL(path);
+	ASSERT_NONNULL(view);
 
-	while ((not_eof = _io_read_line(file, &line))) {
-		string_builder_append_substring(builder, line->buffer, 0, line->length);
+	int descriptor = open(path->url->buffer, O_RDONLY | O_CLOEXEC);
+	struct stat info;
 
-		if (not_eof) {
-			string_builder_append_char(builder, '\n');
+	if (descriptor < 0 || fstat(descriptor, &info) != 0 || !S_ISREG(info.st_mode)) {
+		if (descriptor >= 0) {
+			close(descriptor);
 		}
 
-		string_free(line);
+		return false;
 	}
 
-	string_free(line);
-	fclose(file);
-	String* built = string_builder_build(builder);
-	string_builder_free(builder);
+	// empty files cannot be mapped, but an empty view needs no memory anyway
+	if (info.st_size == 0) {
+		close(descriptor);
+		*view = string_view_new("", 0);
+		return true;
+	}
+
+	void* mapped = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+	// the mapping holds its own reference to the file
+	close(descriptor);
+
+	if (mapped == MAP_FAILED) {
+		return false;
+	}
+
+	madvise(mapped, (size_t) info.st_size, MADV_SEQUENTIAL);
+	*view = string_view_new(mapped, (size_t) info.st_size);
 
-	return built;
+	return true;
+}
+
+void io_file_unmap(StringView view) {
+	if (view.length > 0) {
+		munmap((void*) view.buffer, view.length);
+	}
 }
 
 Vector* io_file_read_lines(Path* path) {
@@ -47,36 +111,175 @@ Vector* io_file_read_lines(Path* path) {
 
 Vector* io_file_read_n_lines(Path* path, int n) {
 	ASSERT_NONNULL(path);
+	MEMORY_SCOPE_BEGIN(MEMORY_IO);
+
+	if (n < 0) {
+		// the index counts every line first, so the vector is allocated once at its final size
+		LineIndex* index = io_file_index_lines(path);
+		Vector* lines = vector_new(index->count, (Duplicator) string_clone, (Destructor) string_free);
+
+		for (size_t i = 0; i < index->count; i++) {
+			vector_add(lines, string_from_view(line_index_get(index, i)));
+		}
 
-	if (n == 0) {
-		return vector_new(0, (Duplicator) string_clone, (Destructor) string_free);
+		line_index_free(index);
+		MEMORY_SCOPE_END();
+		return lines;
 	}
-	
-	Vector* lines = vector_new(DEFAULT_LINE_PER_FILE, (Duplicator) string_clone, (Destructor) string_free);
-	FILE* file = fopen(path->url->buffer, "r");
 
-	if (!file) {
+	Vector* lines = vector_new(n < IO_READ_LINES_CAPACITY ? n : IO_READ_LINES_CAPACITY, (Duplicator) string_clone, (Destructor) string_free);
+	IoLineReader* reader = n > 0 ? io_line_reader_open(path) : NULL;
+
+	if (!reader) {
+		MEMORY_SCOPE_END();
 		return lines;
 	}
 
-	String* line;	
+	StringView line;
 
-	for (int i = 0; (_io_read_line(file, &line)); i++) {
-		if ((n < 0 || i < n)) {
-			vector_add(lines, line);		
-		} else {
-			// if not adding to vector, free manually
-			string_free(line);
-		}
+	while ((int) lines->count < n && io_line_reader_next(reader, &line)) {
+		vector_add(lines, string_from_view(line));
 	}
 
-	// free the last read and close file
-	string_free(line);
-	fclose(file);
+	io_line_reader_free(reader);
+	MEMORY_SCOPE_END();
 
 	return lines;
 }
 
+LineIndex* io_file_index_lines(Path* path) {
+	ASSERT_NONNULL(path);
+	MEMORY_SCOPE_BEGIN(MEMORY_IO);
+
+	String* contents = io_file_read(path);
+	const char* buffer = contents->buffer;
+	const char* end = buffer + contents->length;
+	size_t count = 0;
+
+	// a branchless count the compiler vectorizes, so the offsets are allocated once at their final size
+	for (const char* current = buffer; current < end; current++) {
+		count += *current == '\n';
+	}
+
+	bool unterminated = contents->length > 0 && end[-1] != '\n';
+	count += unterminated;
+
+	LineIndex* index = allocate(sizeof(LineIndex) + (count + 1) * sizeof(size_t));
+	index->contents = contents;
+	index->count = count;
+	index->offsets = (size_t*) (index + 1);
+	index->offsets[0] = 0;
+
+	size_t line = 1;
+
+	for (size_t i = 0; i < contents->length; i++) {
+		if (buffer[i] == '\n') {
+			index->offsets[line++] = i + 1;
+		}
+	}
+
+	if (unterminated) {
+		index->offsets[count] = contents->length + 1;
+	}
+
+	MEMORY_SCOPE_END();
+
+	return index;
+}
+
+StringView line_index_get(LineIndex* index, size_t i) {
+	ASSERT_NONNULL(index);
+	ASSERT_VALID_BOUNDS(index, (int) i, (int) index->count);
+
+	size_t start = index->offsets[i];
+
+	return string_view_new(index->contents->buffer + start, index->offsets[i + 1] - start - 1);
+}
+
+void line_index_free(LineIndex* index) {
+	ASSERT_NONNULL(index);
+
+	string_free(index->contents);
+	deallocate(index);
+}
+
+IoLineReader* io_line_reader_new(FILE* file, size_t capacity) {
+	ASSERT_NONNULL(file);
+	MEMORY_SCOPE_BEGIN(MEMORY_IO);
+
+	IoLineReader* reader = allocate(sizeof(IoLineReader));
+	reader->file = file;
+	reader->owns_file = false;
+	reader->capacity = capacity > 0 ? capacity : IO_LINE_READER_CAPACITY;
+	reader->buffer = allocate(reader->capacity);
+	reader->start = 0;
+	reader->end = 0;
+	reader->eof = false;
+
+	MEMORY_SCOPE_END();
+
+	return reader;
+}
+
+IoLineReader* io_line_reader_open(Path* path) {
+	ASSERT_NONNULL(path);
+
+	FILE* file = fopen(path->url->buffer, "rb");
+
+	if (!file) {
+		return NULL;
+	}
+
+	IoLineReader* reader = io_line_reader_new(file, 0);
+	reader->owns_file = true;
+
+	return reader;
+}
+
+bool io_line_reader_next(IoLineReader* reader, StringView* line) {
+	ASSERT_NONNULL(reader);
+	ASSERT_NONNULL(line);
+
+	// only the bytes read since the last search are scanned for a newline
+	size_t scanned = reader->start;
+
+	for (;;) {
+		char* found = memchr(reader->buffer + scanned, '\n', reader->end - scanned);
+
+		if (found != NULL) {
+			*line = string_view_new(reader->buffer + reader->start, found - (reader->buffer + reader->start));
+			reader->start = found - reader->buffer + 1;
+			return true;
+		}
+
+		scanned = reader->end - reader->start;
+
+		if (reader->eof || !_io_line_reader_refill(reader)) {
+			break;
+		}
+	}
+
+	// a last line without a newline ends at the end of the stream
+	if (reader->end > reader->start) {
+		*line = string_view_new(reader->buffer + reader->start, reader->end - reader->start);
+		reader->start = reader->end;
+		return true;
+	}
+
+	return false;
+}
+
+void io_line_reader_free(IoLineReader* reader) {
+	ASSERT_NONNULL(reader);
+
+	if (reader->owns_file) {
+		fclose(reader->file);
+	}
+
+	deallocate(reader->buffer);
+	deallocate(reader);
+}
+
 bool io_input_read_line(String** dest) {
 	return _io_read_line(stdin, dest);
 }
@@ -89,29 +292,102 @@ bool io_file_read_line(String** dest, FILE* file) {
 
 // return false if we are at the end of file
 bool _io_read_line(FILE* stream, String** dest) {
+	MEMORY_SCOPE_BEGIN(MEMORY_IO);
+
+	// getline reads whole blocks and keeps embedded '\0' and 0xFF bytes as part of the line
+	char* read = NULL;
+	size_t capacity = 0;
+	ssize_t length = getline(&read, &capacity, stream);
+
+	if (length <= 0) {
+		free(read);
+		*dest = string_empty();
+		MEMORY_SCOPE_END();
+		return false;
+	}
+
+	if (read[length - 1] == '\n') {
+		length--;
+	}
+
+	*dest = string_allocate((size_t) length);
+	memcpy((*dest)->buffer, read, (size_t) length);
+	free(read);
+	MEMORY_SCOPE_END();
+
+	return true;
+}
+
+// Moves the unread bytes to the front, growing the buffer if they fill it, and reads more after them
+bool _io_line_reader_refill(IoLineReader* reader) {
+	size_t pending = reader->end - reader->start;
+
+	if (reader->start > 0) {
+		memmove(reader->buffer, reader->buffer + reader->start, pending);
+		reader->start = 0;
+		reader->end = pending;
+	}
+
+	if (pending == reader->capacity) {
+		size_t capacity = reader->capacity * 2;
+		reader->buffer = reallocate(reader->buffer, capacity);
+		reader->capacity = capacity;
+	}
+
+	// one read returns whatever is available, so a line from a pipe or terminal is returned as soon
+	// as it arrives instead of waiting for the rest of the buffer to fill
+	ssize_t count;
+
+	do {
+		count = read(fileno(reader->file), reader->buffer + reader->end, reader->capacity - reader->end);
+	} while (count < 0 && errno == EINTR);
+
+	if (count <= 0) {
+		reader->eof = true;
+		return false;
+	}
+
+	reader->end += (size_t) count;
+
+	return true;
+}
+
+// Reads until end of file straight into the spare capacity of a builder
+String* _io_read_stream(int descriptor) {
 	StringBuilder* builder = string_builder_new();
-	char current;
-	bool eof = false;
 
-	while ((current = fgetc(stream))) {
-		if (current == '\0') {
+	for (;;) {
+		string_builder_reserve(builder, IO_READ_CHUNK);
+		ssize_t read = _io_read_fully(descriptor, builder->buffer + builder->length, builder->capacity - builder->length);
+
+		if (read <= 0) {
 			break;
 		}
 
-		if (current == -1) {
-			eof = true;
-			break;
+		builder->length += (size_t) read;
+	}
+
+	return string_builder_build_move(builder);
+}
+
+// Reads until the buffer is full or the file ends, retrying interrupted and short reads.
+// Returns the number of bytes read, or -1 if nothing could be read
+ssize_t _io_read_fully(int descriptor, char* buffer, size_t length) {
+	size_t total = 0;
+
+	while (total < length) {
+		ssize_t count = read(descriptor, buffer + total, length - total);
+
+		if (count < 0 && errno == EINTR) {
+			continue;
 		}
 
-		if (current == '\n') {
-			break;
+		if (count <= 0) {
+			return total > 0 ? (ssize_t) total : count;
 		}
 
-		string_builder_append_char(builder, current);
-	}	
-		
-	*dest = string_builder_build(builder);
-	string_builder_free(builder);
+		total += (size_t) count;
+	}
 
-	return !eof;
+	return (ssize_t) total;
 }
@@ -3,17 +3,136 @@
 
 #include "path.h"
 #include "../string/string.h"
+#include "../string/string_view.h"
 
-/*
- * Redefining DEFAULT_LINE_PER_FILE larger will result in less reallocations for larger files,
- * but will cause excess memory allocations for smaller average files
+/**
+ * Returns the whole contents of the file, or an empty string if it cannot be read.
+ * Regular files are read with a single read sized by fstat
  */
-#define DEFAULT_LINE_PER_FILE 10 
-
 String* io_file_read(Path* path);
+
+/**
+ * Maps the file read-only into memory and sets "view" to its contents, so a file of any size
+ * is loaded by a few system calls and paged in as it is read, without copying.
+ * The kernel is told the mapping will be read sequentially, so it reads ahead aggressively.
+ * Returns false and leaves "view" untouched if the file cannot be opened or mapped.
+ * The view must be released with `io_file_unmap()`
+ */
+bool io_file_map(Path* path, StringView* view);
+
+/**
+ * Releases a view returned by `io_file_map()`
+ */
+void io_file_unmap(StringView view);
+#ifndef IO_LINE_READER_CAPACITY
+
+/**
+ * IO_LINE_READER_CAPACITY is the default buffer size of an IoLineReader.
+ * Lines longer than the buffer make it grow, so this only trades memory for fewer reads
+ */
+#define IO_LINE_READER_CAPACITY (64 * 1024)
+#endif
+
+/**
+ * IoLineReader reads a stream line by line through one refillable buffer. Newlines are found
+ * with memchr over whole blocks and lines are returned as views into the buffer, so reading
+ * any number of lines allocates nothing once the buffer fits the longest line.
+ *
+ * Bytes in "buffer" from "start" to "end" are read but not yet returned. When no newline is
+ * left among them, they are moved to the front of the buffer and the rest is refilled with a
+ * single read of the underlying descriptor, which returns as soon as any bytes are available.
+ *
+ * The reader owns the stream's buffering: it reads the descriptor directly, so bytes already
+ * buffered by earlier stdio reads on the stream are not seen, and the stream must not be read
+ * through stdio while the reader is in use.
+ */
+typedef struct {
+	FILE* file;
+	bool owns_file;
+	char* buffer;
+	size_t capacity;
+	size_t start;
+	size_t end;
+	bool eof;
+} IoLineReader;
+
+/**
+ * LineIndex holds every line of a file in two allocations: "contents" is the whole file, and
+ * "offsets" the start of each of the "count" lines followed by one past the end of the last line,
+ * so line i spans from offsets[i] to offsets[i + 1] - 1, excluding its newline.
+ * A last line without a trailing newline is a line like any other.
+ *
+ * The offsets share the allocation of the index itself, so `line_index_free()` releases everything.
+ */
+typedef struct {
+	String* contents;
+	size_t count;
+	size_t* offsets;
+} LineIndex;
+
+/**
+ * Returns a new vector with a string for each line of the file, without newlines
+ */
 Vector* io_file_read_lines(Path* path);
+
+/**
+ * Returns a new vector with a string for each of the first n lines of the file, or all lines if n is negative.
+ * Reading stops after the nth line
+ */
 Vector* io_file_read_n_lines(Path* path, int n);
+
+/**
+ * Reads the whole file once and indexes its lines, or returns an empty index if it cannot be read
+ */
+LineIndex* io_file_index_lines(Path* path);
+
+/**
+ * Returns a view of line i without its newline, valid until the index is freed
+ */
+StringView line_index_get(LineIndex* index, size_t i);
+
+/**
+ * Frees the index along with the file contents
+ */
+void line_index_free(LineIndex* index);
+
+/**
+ * Reads the next line without its newline into a new string.
+ * Returns false once the stream is exhausted, in which case "dest" is set to an empty string
+ * that must still be freed. A last line without a trailing newline is returned like any other.
+ *
+ * Every call allocates, both a read buffer and the returned string, so reading many lines
+ * should go through an IoLineReader, which reuses one buffer and allocates nothing per line
+ */
 bool io_file_read_line(String** dest, FILE* file);
+
+/**
+ * Same as `io_file_read_line()` for stdin, allocating on every call the same way.
+ * Reading all of stdin is cheaper through `io_line_reader_new(stdin, 0)`
+ */
 bool io_input_read_line(String** dest);
 
+/**
+ * Creates a line reader over an open stream, which the reader does not close.
+ * A capacity of 0 uses IO_LINE_READER_CAPACITY
+ */
+IoLineReader* io_line_reader_new(FILE* file, size_t capacity);
+
+/**
+ * Creates a line reader over the file at the given path, or returns null if it cannot be opened
+ */
+IoLineReader* io_line_reader_open(Path* path);
+
+/**
+ * Sets "line" to the next line without its newline and returns true, or returns false at
+ * the end of the stream. The view stays valid until the next call or until the reader is freed.
+ * Lines may contain any byte, including '\0'
+ */
+bool io_line_reader_next(IoLineReader* reader, StringView* line);
+
+/**
+ * Frees the reader and its buffer, closing the file if the reader opened it
+ */
+void io_line_reader_free(IoLineReader* reader);
+
 #endif
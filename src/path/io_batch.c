@@ -0,0 +1,522 @@
+#define MEMORY_SUBSYSTEM MEMORY_IO
+#include "io_batch.h"
+#include "../error/error.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+/**
+ * Largest single read queued on the ring, whose lengths are 32 bits wide.
+ * Larger buffers are filled by several reads in turn
+ */
+#define IO_BATCH_MAX_READ (1u << 30)
+
+/**
+ * Largest depth a batch accepts, well below the kernel's limit on ring entries
+ */
+#define IO_BATCH_MAX_DEPTH 4096
+
+#ifdef __linux__
+
+/**
+ * Every file goes through these stages one request at a time, and the stage of a completion
+ * is kept in the low bits of its user data next to the index of its read
+ */
+typedef enum {
+	IO_BATCH_OPEN,
+	IO_BATCH_READ,
+	IO_BATCH_CLOSE,
+} IoBatchStage;
+
+#define IO_BATCH_STAGE_BITS 2
+
+/**
+ * The submission and completion rings shared with the kernel, as laid out by io_uring_setup
+ */
+struct IoBatchRing {
+	int descriptor;
+	unsigned* sq_tail;
+	unsigned* sq_mask;
+	unsigned* sq_array;
+	unsigned* cq_head;
+	unsigned* cq_tail;
+	unsigned* cq_mask;
+	struct io_uring_sqe* sqes;
+	struct io_uring_cqe* cqes;
+	void* rings;
+	size_t rings_size;
+	size_t sqes_size;
+	unsigned queued;
+};
+
+bool _io_batch_ring_supports(int descriptor);
+struct io_uring_sqe* _io_batch_queue(struct IoBatchRing* ring, uint8_t opcode, size_t index, IoBatchStage stage);
+void _io_batch_queue_read(struct IoBatchRing* ring, IoBatchRead* read, int descriptor, size_t index);
+void _io_batch_submit(struct IoBatchRing* ring);
+#endif
+
+typedef struct {
+	IoBatchRead* reads;
+	size_t count;
+	size_t next;
+} IoBatchJob;
+
+/**
+ * Threads started with a batch. Each read publishes its job and wakes "wanted" of them, no more
+ * than it has files for. A read only returns once "active" is back to 0 and the job is withdrawn,
+ * so a worker waking late finds no job instead of one that has already returned
+ */
+struct IoBatchWorkers {
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	pthread_cond_t idle;
+	IoBatchJob* job;
+	size_t wanted;
+	size_t active;
+	bool stopping;
+	size_t count;
+	pthread_t threads[];
+};
+
+struct IoBatchRing* _io_batch_ring_new(size_t depth);
+void _io_batch_ring_free(struct IoBatchRing* ring);
+void _io_batch_read_ring(IoBatch* batch, IoBatchRead* reads, size_t count);
+struct IoBatchWorkers* _io_batch_workers_new(size_t count);
+void _io_batch_workers_free(struct IoBatchWorkers* workers);
+void _io_batch_read_threads(IoBatch* batch, IoBatchRead* reads, size_t count);
+void* _io_batch_worker(void* argument);
+void _io_batch_work(IoBatchJob* job);
+void _io_batch_read_one(IoBatchRead* read);
+
+IoBatch* io_batch_new(size_t depth, IoBatchBackend backend) {
+	MEMORY_SCOPE_BEGIN(MEMORY_IO);
+
+	IoBatch* batch = allocate(sizeof(IoBatch));
+	batch->depth = depth == 0 ? IO_BATCH_DEPTH : depth < IO_BATCH_MAX_DEPTH ? depth : IO_BATCH_MAX_DEPTH;
+	batch->ring = backend != IO_BATCH_THREADS ? _io_batch_ring_new(batch->depth) : NULL;
+	batch->backend = batch->ring != NULL ? IO_BATCH_URING : IO_BATCH_THREADS;
+	batch->workers = batch->ring == NULL ? _io_batch_workers_new(batch->depth - 1) : NULL;
+
+	MEMORY_SCOPE_END();
+
+	return batch;
+}
+
+size_t io_batch_read(IoBatch* batch, IoBatchRead* reads, size_t count) {
+	ASSERT_NONNULL(batch);
+
+	if (count == 0) {
+		return 0;
+	}
+
+	ASSERT_NONNULL(reads);
+
+	for (size_t i = 0; i < count; i++) {
+		ASSERT_NONNULL(reads[i].path);
+		reads[i].length = 0;
+		reads[i].error = 0;
+	}
+
+	if (batch->ring != NULL) {
+		_io_batch_read_ring(batch, reads, count);
+	} else {
+		_io_batch_read_threads(batch, reads, count);
+	}
+
+	size_t succeeded = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		succeeded += reads[i].error == 0;
+	}
+
+	return succeeded;
+}
+
+void io_batch_free(IoBatch* batch) {
+	ASSERT_NONNULL(batch);
+
+	if (batch->ring != NULL) {
+		_io_batch_ring_free(batch->ring);
+	}
+
+	if (batch->workers != NULL) {
+		_io_batch_workers_free(batch->workers);
+	}
+
+	deallocate(batch);
+}
+
+// INTERNAL
+
+#ifdef __linux__
+
+struct IoBatchRing* _io_batch_ring_new(size_t depth) {
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	int descriptor = (int) syscall(__NR_io_uring_setup, (unsigned) depth, &params);
+
+	if (descriptor < 0) {
+		return NULL;
+	}
+
+	// opening and closing through the ring needs Linux 5.6, so older kernels use threads
+	if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !_io_batch_ring_supports(descriptor)) {
+		close(descriptor);
+		return NULL;
+	}
+
+	size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	size_t ring_size = sq_size > cq_size ? sq_size : cq_size;
+	size_t sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+	char* rings = mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, descriptor, IORING_OFF_SQ_RING);
+	void* sqes = mmap(NULL, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, descriptor, IORING_OFF_SQES);
+
+	if (rings == MAP_FAILED || sqes == MAP_FAILED) {
+		if (rings != MAP_FAILED) {
+			munmap(rings, ring_size);
+		}
+
+		if (sqes != MAP_FAILED) {
+			munmap(sqes, sqes_size);
+		}
+
+		close(descriptor);
+		return NULL;
+	}
+
+	struct IoBatchRing* ring = allocate(sizeof(struct IoBatchRing));
+	ring->descriptor = descriptor;
+	ring->sq_tail = (unsigned*) (rings + params.sq_off.tail);
+	ring->sq_mask = (unsigned*) (rings + params.sq_off.ring_mask);
+	ring->sq_array = (unsigned*) (rings + params.sq_off.array);
+	ring->cq_head = (unsigned*) (rings + params.cq_off.head);
+	ring->cq_tail = (unsigned*) (rings + params.cq_off.tail);
+	ring->cq_mask = (unsigned*) (rings + params.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe*) (rings + params.cq_off.cqes);
+	ring->sqes = sqes;
+	ring->rings = rings;
+	ring->rings_size = ring_size;
+	ring->sqes_size = sqes_size;
+	ring->queued = 0;
+
+	return ring;
+}
+
+void _io_batch_ring_free(struct IoBatchRing* ring) {
+	munmap(ring->sqes, ring->sqes_size);
+	munmap(ring->rings, ring->rings_size);
+	close(ring->descriptor);
+	deallocate(ring);
+}
+
+// Returns true if the kernel behind the ring knows how to open, read and close
+bool _io_batch_ring_supports(int descriptor) {
+	size_t size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+	struct io_uring_probe* probe = allocate(size);
+	memset(probe, 0, size);
+
+	bool supported = syscall(__NR_io_uring_register, descriptor, IORING_REGISTER_PROBE, probe, 256) == 0;
+	uint8_t required[] = { IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE };
+
+	for (size_t i = 0; supported && i < sizeof(required); i++) {
+		supported = required[i] <= probe->last_op && (probe->ops[required[i]].flags & IO_URING_OP_SUPPORTED);
+	}
+
+	deallocate(probe);
+
+	return supported;
+}
+
+struct io_uring_sqe* _io_batch_queue(struct IoBatchRing* ring, uint8_t opcode, size_t index, IoBatchStage stage) {
+	// only this thread writes the tail, and the kernel only reads it once it is submitted
+	unsigned tail = *ring->sq_tail + ring->queued;
+	unsigned slot = tail & *ring->sq_mask;
+	struct io_uring_sqe* sqe = &ring->sqes[slot];
+
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = opcode;
+	sqe->user_data = ((uint64_t) index << IO_BATCH_STAGE_BITS) | stage;
+	ring->sq_array[slot] = slot;
+	ring->queued++;
+
+	return sqe;
+}
+
+void _io_batch_queue_read(struct IoBatchRing* ring, IoBatchRead* read, int descriptor, size_t index) {
+	size_t remaining = read->capacity - read->length;
+	struct io_uring_sqe* sqe = _io_batch_queue(ring, IORING_OP_READ, index, IO_BATCH_READ);
+
+	sqe->fd = descriptor;
+	sqe->addr = (uint64_t) (uintptr_t) (read->buffer + read->length);
+	sqe->len = remaining < IO_BATCH_MAX_READ ? (uint32_t) remaining : IO_BATCH_MAX_READ;
+	sqe->off = read->length;
+}
+
+// Hands every queued request to the kernel and waits until at least one has completed
+void _io_batch_submit(struct IoBatchRing* ring) {
+	__atomic_store_n(ring->sq_tail, *ring->sq_tail + ring->queued, __ATOMIC_RELEASE);
+
+	unsigned queued = ring->queued;
+	ring->queued = 0;
+
+	for (;;) {
+		long submitted = syscall(__NR_io_uring_enter, ring->descriptor, queued, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+
+		// the kernel may take fewer requests than offered, and the rest stay in the ring for the next call
+		if (submitted >= 0) {
+			if ((unsigned) submitted >= queued) {
+				return;
+			}
+
+			queued -= (unsigned) submitted;
+		} else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+			printf("\nIO_URING ERROR: io_uring_enter failed: %s\nSee: %s (line %d)\n", strerror(errno), __FILE__, __LINE__);
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+void _io_batch_read_ring(IoBatch* batch, IoBatchRead* reads, size_t count) {
+	MEMORY_SCOPE_BEGIN(MEMORY_IO);
+
+	struct IoBatchRing* ring = batch->ring;
+	int* descriptors = allocate(count * sizeof(int));
+	size_t next = 0;
+	size_t in_flight = 0;
+
+	// every file in flight has exactly one request queued or running, so the rings never overflow
+	while (next < count || in_flight > 0) {
+		for (; next < count && in_flight < batch->depth; next++, in_flight++) {
+			struct io_uring_sqe* sqe = _io_batch_queue(ring, IORING_OP_OPENAT, next, IO_BATCH_OPEN);
+			sqe->fd = AT_FDCWD;
+			sqe->addr = (uint64_t) (uintptr_t) reads[next].path->url->buffer;
+			sqe->open_flags = O_RDONLY | O_CLOEXEC;
+		}
+
+		_io_batch_submit(ring);
+
+		unsigned head = *ring->cq_head;
+		unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+		for (; head != tail; head++) {
+			struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+			size_t index = cqe->user_data >> IO_BATCH_STAGE_BITS;
+			IoBatchStage stage = cqe->user_data & ((1 << IO_BATCH_STAGE_BITS) - 1);
+			IoBatchRead* read = &reads[index];
+			int result = cqe->res;
+			bool finished = false;
+
+			if (stage == IO_BATCH_OPEN) {
+				if (result < 0) {
+					read->error = -result;
+					in_flight--;
+					continue;
+				}
+
+				descriptors[index] = result;
+				finished = read->capacity == 0;
+			} else if (stage == IO_BATCH_READ) {
+				if (result < 0) {
+					read->error = -result;
+				} else {
+					read->length += (size_t) result;
+				}
+
+				// a short read before the end of the file asks for the rest
+				finished = result <= 0 || read->length == read->capacity;
+			} else {
+				in_flight--;
+				continue;
+			}
+
+			if (finished) {
+				struct io_uring_sqe* sqe = _io_batch_queue(ring, IORING_OP_CLOSE, index, IO_BATCH_CLOSE);
+				sqe->fd = descriptors[index];
+			} else {
+				_io_batch_queue_read(ring, read, descriptors[index], index);
+			}
+		}
+
+		__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+	}
+
+	deallocate(descriptors);
+	MEMORY_SCOPE_END();
+}
+
+#else
+
+// io_uring only exists on Linux, so every batch elsewhere reads with threads
+struct IoBatchRing* _io_batch_ring_new(size_t depth) {
+	(void) depth;
+	return NULL;
+}
+
+void _io_batch_ring_free(struct IoBatchRing* ring) {
+	(void) ring;
+}
+
+void _io_batch_read_ring(IoBatch* batch, IoBatchRead* reads, size_t count) {
+	_io_batch_read_threads(batch, reads, count);
+}
+
+#endif
+
+struct IoBatchWorkers* _io_batch_workers_new(size_t count) {
+	MEMORY_SCOPE_BEGIN(MEMORY_IO);
+
+	struct IoBatchWorkers* workers = allocate(sizeof(struct IoBatchWorkers) + count * sizeof(pthread_t));
+	pthread_mutex_init(&workers->lock, NULL);
+	pthread_cond_init(&workers->wake, NULL);
+	pthread_cond_init(&workers->idle, NULL);
+	workers->job = NULL;
+	workers->wanted = 0;
+	workers->active = 0;
+	workers->stopping = false;
+	workers->count = 0;
+
+	// a worker that fails to start only leaves more files for the others
+	for (size_t i = 0; i < count; i++) {
+		if (pthread_create(&workers->threads[workers->count], NULL, _io_batch_worker, workers) == 0) {
+			workers->count++;
+		}
+	}
+
+	MEMORY_SCOPE_END();
+
+	return workers;
+}
+
+void _io_batch_workers_free(struct IoBatchWorkers* workers) {
+	pthread_mutex_lock(&workers->lock);
+	workers->stopping = true;
+	pthread_cond_broadcast(&workers->wake);
+	pthread_mutex_unlock(&workers->lock);
+
+	for (size_t i = 0; i < workers->count; i++) {
+		pthread_join(workers->threads[i], NULL);
+	}
+
+	pthread_cond_destroy(&workers->idle);
+	pthread_cond_destroy(&workers->wake);
+	pthread_mutex_destroy(&workers->lock);
+	deallocate(workers);
+}
+
+void _io_batch_read_threads(IoBatch* batch, IoBatchRead* reads, size_t count) {
+	struct IoBatchWorkers* workers = batch->workers;
+	IoBatchJob job = { reads, count, 0 };
+
+	// the calling thread takes one file, so only the others need a worker
+	size_t wanted = count - 1 < workers->count ? count - 1 : workers->count;
+
+	if (wanted > 0) {
+		pthread_mutex_lock(&workers->lock);
+		workers->job = &job;
+		workers->wanted = wanted;
+
+		for (size_t i = 0; i < wanted; i++) {
+			pthread_cond_signal(&workers->wake);
+		}
+
+		pthread_mutex_unlock(&workers->lock);
+	}
+
+	_io_batch_work(&job);
+
+	if (wanted > 0) {
+		pthread_mutex_lock(&workers->lock);
+		workers->wanted = 0;
+
+		while (workers->active > 0) {
+			pthread_cond_wait(&workers->idle, &workers->lock);
+		}
+
+		workers->job = NULL;
+		pthread_mutex_unlock(&workers->lock);
+	}
+}
+
+void* _io_batch_worker(void* argument) {
+	struct IoBatchWorkers* workers = argument;
+
+	pthread_mutex_lock(&workers->lock);
+
+	for (;;) {
+		while (!workers->stopping && workers->wanted == 0) {
+			pthread_cond_wait(&workers->wake, &workers->lock);
+		}
+
+		if (workers->stopping) {
+			break;
+		}
+
+		IoBatchJob* job = workers->job;
+		workers->wanted--;
+		workers->active++;
+		pthread_mutex_unlock(&workers->lock);
+
+		_io_batch_work(job);
+
+		pthread_mutex_lock(&workers->lock);
+
+		if (--workers->active == 0) {
+			pthread_cond_signal(&workers->idle);
+		}
+	}
+
+	pthread_mutex_unlock(&workers->lock);
+
+	return NULL;
+}
+
+void _io_batch_work(IoBatchJob* job) {
+	size_t index;
+
+	while ((index = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED)) < job->count) {
+		_io_batch_read_one(&job->reads[index]);
+	}
+}
+
+void _io_batch_read_one(IoBatchRead* read) {
+	int descriptor = open(read->path->url->buffer, O_RDONLY | O_CLOEXEC);
+
+	if (descriptor < 0) {
+		read->error = errno;
+		return;
+	}
+
+	while (read->length < read->capacity) {
+		ssize_t result = pread(descriptor, read->buffer + read->length, read->capacity - read->length, read->length);
+
+		if (result < 0 && errno == EINTR) {
+			continue;
+		}
+
+		if (result < 0) {
+			read->error = errno;
+			break;
+		}
+
+		if (result == 0) {
+			break;
+		}
+
+		read->length += (size_t) result;
+	}
+
+	close(descriptor);
+}
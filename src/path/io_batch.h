@@ -0,0 +1,74 @@
+#ifndef NORMALC_IO_BATCH_H
+#define NORMALC_IO_BATCH_H
+
+#include "path.h"
+
+#ifndef IO_BATCH_DEPTH
+
+/**
+ * IO_BATCH_DEPTH is the default number of files an IoBatch has open and in flight at once.
+ * Deeper batches hide more latency on cold storage at the cost of more open descriptors
+ */
+#define IO_BATCH_DEPTH 64
+#endif
+
+/**
+ * How an IoBatch issues its reads. IO_BATCH_AUTO picks io_uring when the kernel offers it
+ * and falls back to a pool of threads calling pread otherwise, as on every system but Linux
+ */
+typedef enum {
+	IO_BATCH_AUTO,
+	IO_BATCH_URING,
+	IO_BATCH_THREADS,
+} IoBatchBackend;
+
+/**
+ * IoBatchRead describes a single file to read into a caller owned buffer.
+ * "path", "buffer" and "capacity" are set by the caller, and at most "capacity" bytes from the
+ * start of the file are read. Once the batch completes, "length" holds the number of bytes read
+ * and "error" is 0, or the errno of the open or read that failed
+ */
+typedef struct {
+	Path* path;
+	char* buffer;
+	size_t capacity;
+	size_t length;
+	int error;
+} IoBatchRead;
+
+struct IoBatchRing;
+struct IoBatchWorkers;
+
+/**
+ * IoBatch reads many files at once. With io_uring, the opens, reads and closes of up to
+ * "depth" files are queued together and submitted by a single system call, so the latency
+ * of one file overlaps with the others instead of adding up. Without it, the calling thread
+ * and "depth" - 1 worker threads each open, pread and close files one at a time. The workers
+ * are started with the batch and wait between reads, so reading costs no thread creation
+ */
+typedef struct {
+	IoBatchBackend backend;
+	size_t depth;
+	struct IoBatchRing* ring;
+	struct IoBatchWorkers* workers;
+} IoBatch;
+
+/**
+ * Creates a batch that keeps up to "depth" files in flight, or IO_BATCH_DEPTH if it is 0.
+ * Asking for IO_BATCH_URING when io_uring is unavailable returns a batch using IO_BATCH_THREADS,
+ * so "backend" tells which one is actually used
+ */
+IoBatch* io_batch_new(size_t depth, IoBatchBackend backend);
+
+/**
+ * Reads every file described by "reads" into its buffer, in any order, and returns once all
+ * of them are complete. Returns the number of files read without an error
+ */
+size_t io_batch_read(IoBatch* batch, IoBatchRead* reads, size_t count);
+
+/**
+ * Frees the batch along with its ring or its worker threads
+ */
+void io_batch_free(IoBatch* batch);
+
+#endif
@@ -0,0 +1,209 @@
+#define MEMORY_SUBSYSTEM MEMORY_IO
+#include "io_parallel.h"
+#include "io.h"
+#include "../error/error.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * Thread states are padded to whole cache lines, so threads writing their own state
+ * never invalidate the lines of their neighbours
+ */
+#define IO_PARALLEL_CACHE_LINE 64
+
+typedef struct {
+	StringView view;
+	IoParallel* options;
+	IoChunkProcessor process_chunk;
+	IoLineProcessor process_line;
+	size_t chunk_size;
+	size_t chunk_count;
+	size_t next_chunk;
+} IoParallelJob;
+
+typedef struct {
+	IoParallelJob* job;
+	void* local;
+	pthread_t thread;
+	bool started;
+} IoParallelWorker;
+
+size_t _io_parallel_run(IoParallelJob* job, void* result);
+void* _io_parallel_work(void* argument);
+size_t _io_parallel_line_start(StringView view, size_t window, size_t size);
+size_t _io_parallel_boundary(StringView view, size_t position);
+void _io_parallel_split_lines(IoParallelJob* job, StringView chunk, void* local);
+
+size_t io_view_process_chunks(StringView view, IoParallel* options, IoChunkProcessor process, void* result) {
+	ASSERT_NONNULL(options);
+	ASSERT_NONNULL(process);
+
+	IoParallelJob job = { view, options, process, NULL, 0, 0, 0 };
+	return _io_parallel_run(&job, result);
+}
+
+size_t io_view_process_lines(StringView view, IoParallel* options, IoLineProcessor process, void* result) {
+	ASSERT_NONNULL(options);
+	ASSERT_NONNULL(process);
+
+	IoParallelJob job = { view, options, NULL, process, 0, 0, 0 };
+	return _io_parallel_run(&job, result);
+}
+
+bool io_file_process_chunks(Path* path, IoParallel* options, IoChunkProcessor process, void* result) {
+	StringView view;
+
+	if (!io_file_map(path, &view)) {
+		return false;
+	}
+
+	io_view_process_chunks(view, options, process, result);
+	io_file_unmap(view);
+
+	return true;
+}
+
+bool io_file_process_lines(Path* path, IoParallel* options, IoLineProcessor process, void* result) {
+	StringView view;
+
+	if (!io_file_map(path, &view)) {
+		return false;
+	}
+
+	io_view_process_lines(view, options, process, result);
+	io_file_unmap(view);
+
+	return true;
+}
+
+// INTERNAL
+
+size_t _io_parallel_run(IoParallelJob* job, void* result) {
+	MEMORY_SCOPE_BEGIN(MEMORY_IO);
+
+	IoParallel* options = job->options;
+	job->chunk_size = options->chunk_size > 0 ? options->chunk_size : IO_PARALLEL_CHUNK_SIZE;
+	job->chunk_count = (job->view.length + job->chunk_size - 1) / job->chunk_size;
+
+	size_t threads = options->threads;
+
+	if (threads == 0) {
+		long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = cores > 0 ? (size_t) cores : 1;
+	}
+
+	// never more threads than chunks, but always one so every result is initialized and merged the same way
+	if (threads > job->chunk_count) {
+		threads = job->chunk_count > 0 ? job->chunk_count : 1;
+	}
+
+	size_t stride = (options->local_size + IO_PARALLEL_CACHE_LINE - 1) & ~(size_t) (IO_PARALLEL_CACHE_LINE - 1);
+	IoParallelWorker* workers = allocate(threads * sizeof(IoParallelWorker));
+	char* block = allocate(threads * stride + IO_PARALLEL_CACHE_LINE);
+	char* locals = (char*) (((uintptr_t) block + IO_PARALLEL_CACHE_LINE - 1) & ~(uintptr_t) (IO_PARALLEL_CACHE_LINE - 1));
+	memset(locals, 0, threads * stride);
+
+	for (size_t i = 0; i < threads; i++) {
+		workers[i].job = job;
+		workers[i].local = options->local_size > 0 ? locals + i * stride : NULL;
+		workers[i].started = false;
+
+		if (options->init) {
+			options->init(workers[i].local, options->context);
+		}
+	}
+
+	// the calling thread is worker 0, and a worker that fails to start only leaves more chunks for the others
+	for (size_t i = 1; i < threads; i++) {
+		workers[i].started = pthread_create(&workers[i].thread, NULL, _io_parallel_work, &workers[i]) == 0;
+	}
+
+	_io_parallel_work(&workers[0]);
+
+	for (size_t i = 0; i < threads; i++) {
+		if (workers[i].started) {
+			pthread_join(workers[i].thread, NULL);
+		}
+
+		if (options->merge) {
+			options->merge(result, workers[i].local, options->context);
+		}
+	}
+
+	deallocate(block);
+	deallocate(workers);
+	MEMORY_SCOPE_END();
+
+	return threads;
+}
+
+void* _io_parallel_work(void* argument) {
+	IoParallelWorker* worker = argument;
+	IoParallelJob* job = worker->job;
+	size_t chunk;
+
+	while ((chunk = __atomic_fetch_add(&job->next_chunk, 1, __ATOMIC_RELAXED)) < job->chunk_count) {
+		// a chunk owns the lines starting inside its window and ends where the next window's
+		// first line starts, so chunks never overlap. Only the window is searched for the start,
+		// so a line longer than a chunk is scanned once by its owner, not by every chunk it covers
+		size_t window = chunk * job->chunk_size;
+		size_t start = _io_parallel_line_start(job->view, window, job->chunk_size);
+
+		if (start == SIZE_MAX) {
+			continue;
+		}
+
+		size_t end = _io_parallel_boundary(job->view, window + job->chunk_size);
+		StringView view = string_view_new(job->view.buffer + start, end - start);
+
+		if (job->process_chunk) {
+			job->process_chunk(view, worker->local, job->options->context);
+		} else {
+			_io_parallel_split_lines(job, view, worker->local);
+		}
+	}
+
+	return NULL;
+}
+
+// Returns the start of the first line beginning inside the window, or SIZE_MAX if none does
+size_t _io_parallel_line_start(StringView view, size_t window, size_t size) {
+	if (window == 0) {
+		return 0;
+	}
+
+	size_t end = window + size < view.length ? window + size : view.length;
+	const char* found = memchr(view.buffer + window - 1, '\n', end - window);
+
+	return found != NULL ? (size_t) (found - view.buffer) + 1 : SIZE_MAX;
+}
+
+// Returns the start of the first line beginning at or after the given position
+size_t _io_parallel_boundary(StringView view, size_t position) {
+	if (position == 0) {
+		return 0;
+	}
+
+	if (position >= view.length) {
+		return view.length;
+	}
+
+	const char* found = memchr(view.buffer + position - 1, '\n', view.length - position + 1);
+
+	return found != NULL ? (size_t) (found - view.buffer) + 1 : view.length;
+}
+
+void _io_parallel_split_lines(IoParallelJob* job, StringView chunk, void* local) {
+	const char* current = chunk.buffer;
+	const char* end = chunk.buffer + chunk.length;
+
+	while (current < end) {
+		const char* stop = memchr(current, '\n', end - current);
+		size_t length = stop != NULL ? (size_t) (stop - current) : (size_t) (end - current);
+
+		job->process_line(string_view_new(current, length), local, job->options->context);
+		current += length + 1;
+	}
+}
@@ -0,0 +1,82 @@
+#ifndef NORMALC_IO_PARALLEL_H
+#define NORMALC_IO_PARALLEL_H
+
+#include "path.h"
+#include "../string/string_view.h"
+
+#ifndef IO_PARALLEL_CHUNK_SIZE
+
+/**
+ * IO_PARALLEL_CHUNK_SIZE is the default number of bytes a worker takes at a time.
+ * Workers take the next chunk as soon as they finish one, so smaller chunks balance uneven
+ * lines better while larger ones spend less time handing chunks out
+ */
+#define IO_PARALLEL_CHUNK_SIZE (1024 * 1024)
+#endif
+
+/**
+ * Called with a run of whole lines, every one of them ending with its newline except perhaps
+ * the very last line of the input. "local" is the state of the calling thread
+ */
+typedef void (*IoChunkProcessor)(StringView chunk, void* local, void* context);
+
+/**
+ * Called with a single line without its newline. "local" is the state of the calling thread
+ */
+typedef void (*IoLineProcessor)(StringView line, void* local, void* context);
+
+/**
+ * Called once for each thread's zeroed state before it processes anything
+ */
+typedef void (*IoLocalInitializer)(void* local, void* context);
+
+/**
+ * Called on the calling thread to fold one thread's state into the result.
+ * It is the last call to see that state, so it must release whatever the initializer acquired
+ */
+typedef void (*IoLocalMerger)(void* result, void* local, void* context);
+
+/**
+ * IoParallel configures how input is split across worker threads.
+ * Zero "threads" uses one thread per online core, and zero "chunk_size" uses IO_PARALLEL_CHUNK_SIZE.
+ *
+ * Every thread gets its own "local_size" bytes of state, so callbacks never share anything
+ * they write and need no locks. When all input is processed, "merge" folds each thread's
+ * state into the result, in thread order. "init", "merge" and "context" may all be null
+ */
+typedef struct {
+	size_t threads;
+	size_t chunk_size;
+	size_t local_size;
+	IoLocalInitializer init;
+	IoLocalMerger merge;
+	void* context;
+} IoParallel;
+
+/**
+ * Splits the view into chunks of about "chunk_size" bytes, moved forward to the next line start,
+ * and runs "process" on each chunk from a pool of worker threads.
+ * The calling thread works as well and returns once every chunk is processed and merged into "result".
+ * Returns the number of threads whose state was merged
+ */
+size_t io_view_process_chunks(StringView view, IoParallel* options, IoChunkProcessor process, void* result);
+
+/**
+ * Same as `io_view_process_chunks()`, but runs "process" on each line of every chunk.
+ * A last line without a newline is a line like any other, and a trailing newline adds no empty line
+ */
+size_t io_view_process_lines(StringView view, IoParallel* options, IoLineProcessor process, void* result);
+
+/**
+ * Maps the file with `io_file_map()` and processes it with `io_view_process_chunks()`.
+ * Returns false without calling anything if the file cannot be mapped
+ */
+bool io_file_process_chunks(Path* path, IoParallel* options, IoChunkProcessor process, void* result);
+
+/**
+ * Maps the file with `io_file_map()` and processes it with `io_view_process_lines()`.
+ * Returns false without calling anything if the file cannot be mapped
+ */
+bool io_file_process_lines(Path* path, IoParallel* options, IoLineProcessor process, void* result);
+
+#endif
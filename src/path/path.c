@@ -1,7 +1,9 @@
+#define MEMORY_SUBSYSTEM MEMORY_PATH
 #include "path.h"
 #include "../memory/memory.h"
 #include "../string/string_builder.h"
 #include "../string/string.h"
+#include "../string/string_view.h"
 #include <normalc/collections/vector.h>
 #include <normalc/string/string_builder.h>
 #include <stdbool.h>
@@ -15,19 +17,19 @@
 #include <dirent.h>
 
 bool _cstring_is_dir(char* path);
+Path* _path_join(Path* path, Array* parts);
 
 Path* path_current() {
 	char* raw = getcwd(NULL, 0);
 	Path* path = allocate(sizeof(Path)); 
-	String* wrapper = allocate(sizeof(String));
-	wrapper->length = strlen(raw) + 2;
-	wrapper->buffer = raw;
+	size_t length = strlen(raw);
+	String* wrapper = string_allocate(length + 1);
 	path->url = wrapper;
 
 	// Append / to cwd
-	wrapper->buffer = reallocate(wrapper->buffer, sizeof(char) * wrapper->length);
-	wrapper->buffer[wrapper->length - 2] = '/';
-	wrapper->buffer[wrapper->length - 1] = '\0';
+	memcpy(wrapper->buffer, raw, length);
+	wrapper->buffer[length] = '/';
+	free(raw);
 
 	return path;
 }
@@ -127,33 +129,16 @@ VECTOR_SAFE(String, string)
 Path* path_remove(Path* path, size_t index) {
 	ASSERT_NONNULL(path);
 
-	Vector* split = string_split(path->url, '/');
-	if (index > split->count - 1) {
-		return path_clone(path);
-	}
-
-	vector_delete(split, index);
-	StringBuilder* builder = string_builder_new();
+	Array* parts = array_new(8, sizeof(StringView));
 	
-	for (size_t i = 0; i < split->count; i++) {
-		bool is_first_dir = path->url->buffer[0] == '/';
-		bool is_final = i == split->count - 1;
-		bool is_last_dir = path->url->buffer[path->url->length - 1] == '/';
-
-		if (i == 0 && is_first_dir) {
-			string_builder_append_char(builder, '/');
-		}
-		
-		string_builder_append(builder, vector_string_get(split, i)->buffer);
-
-		if (!is_final || (is_final && is_last_dir)) {
-			string_builder_append_char(builder, '/');
-		} 
+	if (index >= string_split_views(path->url, '/', parts)) {
+		array_free(parts);
+		return path_clone(path);
 	}
 
-	Path* removed = path_from_string(string_builder_build(builder), true);
-	string_builder_free(builder);
-	vector_free(split);
+	array_remove(parts, index);
+	Path* removed = _path_join(path, parts);
+	array_free(parts);
 
 	return removed;
 }
@@ -212,57 +197,48 @@ String* path_name(Path* path) {
 }
 
 Path* path_normalize(Path* path) {
-	Vector* split = string_split(path->url, '/');
-	Vector* normal_splice = vector_new(split->count * 2, (Duplicator) string_clone, (Destructor) string_free);
-	StringBuilder* normalized = string_builder_new();
+	ASSERT_NONNULL(path);
 
-	for (size_t i = 0; i < split->count; i++) {
-		String* current = vector_string_get(split, i);
+	Array* parts = array_new(8, sizeof(StringView));
+	size_t count = string_split_views(path->url, '/', parts);
+	String* parent_name = NULL;
+	size_t kept = 0;
 
-		if (string_equals(current, "..") && i == 0) {
+	// kept parts are compacted in place, so ".." only has to step back over the last one
+	for (size_t i = 0; i < count; i++) {
+		StringView current = *(StringView*) array_get(parts, i);
+
+		if (string_view_equals(current, string_view_from("..")) && kept > 0) {
+			kept--;
+		} else if (string_view_equals(current, string_view_from("..")) && i == 0) {
 			Path* pwd = path_current();
 			Path* parent = path_parent(pwd);
-			String* parent_name = path_name(parent);						
+			parent_name = path_name(parent);
 
-			vector_delete(normal_splice, i - 1);
-			vector_string_add(normal_splice, parent_name);
+			StringView name = string_view_of(parent_name);
+			array_set(parts, kept++, &name);
 
 			path_free(pwd);
 			path_free(parent);
-		} else if (string_equals(current, "..")) {
-			vector_delete(normal_splice, i - 1);
-		} else {
-			vector_string_add(normal_splice, string_clone(current));
+		} else if (!string_view_equals(current, string_view_from(".."))) {
+			array_set(parts, kept++, &current);
 		}
 	}
 
-	for (size_t i = 0; i < normal_splice->count; i++) {
-		bool is_first_dir = path->url->buffer[0] == '/';
-		bool is_final = i == normal_splice->count - 1;
-		bool is_last_dir = path->url->buffer[path->url->length - 1] == '/';
-
-		if (i == 0 && is_first_dir) {
-			string_builder_append_char(normalized, '/');
-		}
-		
-		string_builder_append(normalized, vector_string_get(normal_splice, i)->buffer);
+	parts->count = kept;
+	Path* normalized_path = _path_join(path, parts);
+	array_free(parts);
 
-		if (!is_final || (is_final && is_last_dir)) {
-			string_builder_append_char(normalized, '/');
-		} 
+	if (parent_name != NULL) {
+		string_free(parent_name);
 	}
 
-	Path* normalized_path = path_from_string(string_builder_build(normalized), true);
-	string_builder_free(normalized);
-	vector_free(split);
-	vector_free(normal_splice);
-
 	return normalized_path;
 } 
 
 void path_free(Path* path) {
 	string_free(path->url);
-	free(path);
+	deallocate(path);
 }
 
 Vector* path_get_files(Path* path, bool use_absolute) {
@@ -314,3 +290,30 @@ bool _cstring_is_dir(char* path) {
 
 	return (path_stat.st_mode & S_IFDIR);
 }
+
+// Joins the parts with '/', keeping the leading and trailing slash of the original path
+Path* _path_join(Path* path, Array* parts) {
+	StringBuilder* builder = string_builder_new();
+	bool is_first_dir = path->url->buffer[0] == '/';
+	bool is_last_dir = path->url->length > 0 && path->url->buffer[path->url->length - 1] == '/';
+
+	for (size_t i = 0; i < parts->count; i++) {
+		StringView part = *(StringView*) array_get(parts, i);
+		bool is_final = i == parts->count - 1;
+
+		if (i == 0 && is_first_dir) {
+			string_builder_append_char(builder, '/');
+		}
+		
+		string_builder_append_substring(builder, (char*) part.buffer, 0, part.length);
+
+		if (!is_final || (is_final && is_last_dir)) {
+			string_builder_append_char(builder, '/');
+		} 
+	}
+
+	Path* joined = path_from_string(string_builder_build(builder), true);
+	string_builder_free(builder);
+
+	return joined;
+}
@@ -1,7 +1,10 @@
+#define MEMORY_SUBSYSTEM MEMORY_STRING
 #include "string.h"
 #include "../memory/memory.h"
 #include "../error/error.h"
 #include "string_builder.h"
+#include "string_search.h"
+#include "../hash/hash.h"
 #include <stdarg.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -10,27 +13,26 @@
 #include <strings.h>
 #include <ctype.h>
 
-String* string_empty() {
-	String* dest = allocate(sizeof(String));
-	char* buffer = (char*) allocate(sizeof(char) * 1);
-	strncpy(buffer, "\0", 1);
-	dest->buffer = buffer;
-	dest->length = 0;	
+String* string_allocate(size_t length) {
+	// contents live inline right after the struct, so a string is a single allocation
+	String* string = (String*) allocate(sizeof(String) + sizeof(char) * (length + 1));
+	string->buffer = (char*) (string + 1);
+	string->length = length;
+	string->buffer[length] = '\0';
+
+	return string;
+}
 
-	return dest;
+String* string_empty() {
+	return string_allocate(0);
 }
 
 String* string_from(char* src) {
 	ASSERT_NONNULL(src);	
 
 	size_t length = strlen(src);
-
-	String* string = (String*) allocate(sizeof(String));
-	string->buffer = (char*) allocate(sizeof(char) * (length + 1));
-	string->length = length; 
-
-	strncpy(string->buffer, src, length);
-	strncpy(string->buffer + length, "\0", 1);
+	String* string = string_allocate(length);
+	memcpy(string->buffer, src, length);
 
 	return string;
 }
@@ -39,12 +41,41 @@ String* string_sub_cstring(char* source, size_t start, size_t length) {
 	ASSERT_NONNULL(source);
 	ASSERT_VALID_RANGE((int) start, (int) (start + length));
 
-	String* string = (String*) allocate(sizeof(String));
-	string->buffer = (char*) allocate(sizeof(char) * (length + 1));
+	String* string = string_allocate(length);
+	memcpy(string->buffer, source + start, length);
+
+	return string;
+}
+
+String* string_from_arena(Arena* arena, char* src) {
+	ASSERT_NONNULL(src);	
+
+	return string_sub_cstring_arena(arena, src, 0, strlen(src));
+}
+
+String* string_sub_cstring_arena(Arena* arena, char* source, size_t start, size_t length) {
+	ASSERT_NONNULL(arena);
+
+	return string_sub_cstring_with(&arena->allocator, source, start, length);
+}
+
+String* string_from_with(Allocator* allocator, char* src) {
+	ASSERT_NONNULL(src);	
+
+	return string_sub_cstring_with(allocator, src, 0, strlen(src));
+}
+
+String* string_sub_cstring_with(Allocator* allocator, char* source, size_t start, size_t length) {
+	ASSERT_NONNULL(allocator);
+	ASSERT_NONNULL(source);
+
+	// struct and buffer share a single allocation
+	String* string = (String*) allocator_allocate(allocator, sizeof(String) + length + 1);
+	string->buffer = (char*) (string + 1);
 	string->length = length; 
 
-	strncpy(string->buffer, source + start, length);
-	strncpy(string->buffer + length, "\0", 1);
+	memcpy(string->buffer, source + start, length);
+	string->buffer[length] = '\0';
 
 	return string;
 }
@@ -54,10 +85,16 @@ String* string_from_format(char* format, ...) {
 
     va_list args;
     va_start(args, format);
+    va_list measure;
+    va_copy(measure, args);
+
+	// measure first so the contents can be written inline
+	int length = vsnprintf(NULL, 0, format, measure);
+    va_end(measure);
+	ASSERT_INT_GREATER(length + 1, 0);
 
-    String* string = (String*) allocate(sizeof(String));
-    vasprintf(&string->buffer, format, args);
-	string->length = strlen(string->buffer);
+    String* string = string_allocate((size_t) length);
+    vsnprintf(string->buffer, length + 1, format, args);
 
     va_end(args);
 
@@ -67,14 +104,34 @@ String* string_from_format(char* format, ...) {
 String* string_clone(String* src) {
 	ASSERT_NONNULL(src);
 
-	return string_from(src->buffer);
+	String* clone = string_allocate(src->length);
+	memcpy(clone->buffer, src->buffer, src->length);
+
+	return clone;
+}
+
+String* string_clone_with(Allocator* allocator, String* src) {
+	ASSERT_NONNULL(src);
+
+	return string_sub_cstring_with(allocator, src->buffer, 0, src->length);
+}
+
+void string_free_with(Allocator* allocator, String* string) {
+	ASSERT_NONNULL(allocator);
+	ASSERT_NONNULL(string);	
+
+	allocator_free(allocator, string, sizeof(String) + string->length + 1);
 }
 
 void string_free(String* string) {
 	ASSERT_NONNULL(string);	
 
-	free(string->buffer);
-	free(string);
+	// strings assembled by hand may still own a separate buffer
+	if (string->buffer != (char*) (string + 1)) {
+		deallocate(string->buffer);
+	}
+
+	deallocate(string);
 	string = NULL;
 }
 
@@ -83,18 +140,9 @@ int string_nth_index_of(String* string, size_t n, char query) {
 	ASSERT_NONNULL(string);
 	ASSERT_NONNULL(string->buffer);
 
-	size_t count = 0;
+	size_t index = string_search_nth_byte(string->buffer, string->length, n, query);
 
-	for (size_t i = 0; i < string->length; i++) {
-		if (string->buffer[i] == query) {
-			count++;
-			if (count >= n) {	
-				return i;
-			}
-		}	
-	}
-	
-	return -1;
+	return index != STRING_SEARCH_NOT_FOUND ? (int) index : -1;
 }
 
 int string_index_of(String* string, char query) {
@@ -102,22 +150,12 @@ int string_index_of(String* string, char query) {
 }
 
 int string_nth_index_of_last(String* string, size_t n, char query) {
-	size_t count = 0;
-
 	ASSERT_NONNULL(string);
 	ASSERT_NONNULL(string->buffer);
 
-	for (size_t i = string->length - 1; i != SIZE_MAX; i--) {
-		if (string->buffer[i] == query) {
-			count++;
-
-			if (count >= n) {
-				return i;
-			}
-		}	
-	}
+	size_t index = string_search_nth_byte_last(string->buffer, string->length, n, query);
 
-	return -1;
+	return index != STRING_SEARCH_NOT_FOUND ? (int) index : -1;
 }
 
 int string_index_of_last(String* string, char query) {
@@ -129,59 +167,19 @@ int string_index_of_string(String* string, char* query) {
 	ASSERT_NONNULL(string->buffer);
 	ASSERT_NONNULL(query);
 
-	if (query[0] == '\0') {
-		return -1;
-	}
-
-	size_t length = strlen(query);
-
-	if (string->length < length) {
-		return -1;
-	}
-
-	for (size_t i = 0; i < string->length - length; i++) {
-		for (size_t j = 0; j < length; j++) {
-			if (string->buffer[i + j] != query[j]) {
-				break;
-			}
+	size_t index = string_search(string->buffer, string->length, query, strlen(query));
 
-			if (j == length - 1) {	
-				return i;
-			}
-		}	
-	}
-
-	return -1;
+	return index != STRING_SEARCH_NOT_FOUND ? (int) index : -1;
 }
 
 int string_index_of_last_string(String* string, char* query) {
 	ASSERT_NONNULL(string);
 	ASSERT_NONNULL(string->buffer);	
 	ASSERT_NONNULL(query);
-	
-	int length = strlen(query);
 
-	if (query[0] == '\0') {
-		return -1;
-	}
+	size_t index = string_search_last(string->buffer, string->length, query, strlen(query));
 
-	if (((int) string->length) < length) {
-		return -1;
-	}
-
-	for (int i = string->length - length - 1; i >= 0; i--) {
-		for (int j = length - 1; j >= 0; j--) {
-			if (string->buffer[i + j] != query[j]) {
-				break;
-			}
-
-			if (j == length -1) {	
-				return i;
-			}
-		}	
-	}
-
-	return -1;
+	return index != STRING_SEARCH_NOT_FOUND ? (int) index : -1;
 }
 
 String* string_substring(String* src, size_t start, size_t length) {
@@ -195,40 +193,24 @@ String* string_substring(String* src, size_t start, size_t length) {
 String* string_replace(String *src, char *replaced, char *replacer) {
 	ASSERT_NONNULL(src);
 	ASSERT_NONNULL(replaced);
-	ASSERT_NONNULL(replaced);
+	ASSERT_NONNULL(replacer);
 
 	StringBuilder* builder = string_builder_new();	
 
 	size_t length_replaced = strlen(replaced);
 	size_t start_unmatched = 0;
-	bool matched = false; 
-
-	for (size_t i = 0; i < src->length; i++) {
-		matched = false;
-
-		// 1.) Check if current index is replaced
-		for (size_t j = 0; j < length_replaced; j++) {
-			if (src->buffer[i + j] != replaced[j]) {
-				// Not a match and not last index
-				break;
-			}
-			
-			matched = (j == length_replaced - 1);	
-		}
-
-		// 2.) Replace matched with replacer
-		if (matched) {
-			string_builder_append_substring(builder, src->buffer, start_unmatched, i - start_unmatched);	
+	size_t matched;
 
-			string_builder_append(builder, replacer);	
-			i += length_replaced - 1;
-			start_unmatched = i + 1;
-		} else if (i == src->length - 1) {
-			// 3.) Add unmatched tail from source
-			string_builder_append_substring(builder, src->buffer, start_unmatched, i - start_unmatched + 1);			
-		}
+	// 1.) Jump straight to each match, copying the unmatched run before it and the replacer
+	while ((matched = string_search(src->buffer + start_unmatched, src->length - start_unmatched, replaced, length_replaced)) != STRING_SEARCH_NOT_FOUND) {
+		string_builder_append_substring(builder, src->buffer, start_unmatched, matched);	
+		string_builder_append(builder, replacer);	
+		start_unmatched += matched + length_replaced;
 	}
 
+	// 2.) Add unmatched tail from source
+	string_builder_append_substring(builder, src->buffer, start_unmatched, src->length - start_unmatched);			
+
 	String* built = string_builder_build(builder);
 	string_builder_free(builder);	
 
@@ -266,34 +248,49 @@ String* string_lowercase(String* src) {
 }
 
 Vector* string_split(String* src, char delimiter) {
+	ASSERT_NONNULL(src);
+
 	Vector* vector = vector_new(1, (Duplicator) string_clone, (Destructor) string_free);
-	size_t last_start = 0;
-
-	for (size_t i = 0; i < src->length; i++) {
-		if (src->buffer[i] == delimiter) {
-			if (i > 0 && src->buffer[i - 1] != delimiter) {		
-				vector_add(vector, string_substring(src, last_start, i - last_start));
-			}
-			last_start = i + 1;
-		} else if (i == src->length - 1 && i > 0 && src->buffer[i - 1] != delimiter) {		
-			vector_add(vector, string_substring(src, last_start, i + 1 - last_start));
+	char* end = src->buffer + src->length;
+	char* start = src->buffer;
+
+	// jump between delimiters with memchr, skipping the empty runs between repeated delimiters
+	while (start < end) {
+		char* found = memchr(start, delimiter, end - start);
+		char* stop = found != NULL ? found : end;
+
+		if (stop > start) {
+			vector_add(vector, string_sub_cstring(start, 0, stop - start));
 		}
+
+		start = stop + 1;
 	}
 
 	return vector;
 }
 
-// Simple hash function provided by Dan Bernstein 
 size_t string_hash(String* src) {
 	ASSERT_NONNULL(src);
 
-	size_t hash = 5381;
+	return string_hash_cstring(src->buffer, src->length);
+}
+
+size_t string_hash_cstring(const char* src, size_t length) {
+	ASSERT_NONNULL(src);
+
+	return (size_t) hash_bytes(src, length, hash_seed());
+}
 
-	for (size_t i = 0; i < src->length; i++) {
-		hash = (hash << 5) + src->buffer[i];
-	}
+size_t string_hash_keyed(String* src) {
+	ASSERT_NONNULL(src);
+
+	return string_hash_cstring_keyed(src->buffer, src->length);
+}
+
+size_t string_hash_cstring_keyed(const char* src, size_t length) {
+	ASSERT_NONNULL(src);
 
-	return hash;
+	return (size_t) hash_siphash(src, length, hash_key());
 }
 
 bool string_equals(String* src, char* other) {
@@ -310,6 +307,13 @@ bool string_equals_ignore_case(String* src, char* other) {
 	return strcasecmp(src->buffer, other) == 0;
 }
 
+bool string_equals_cstring(const char* src, size_t length, String* other) {
+	ASSERT_NONNULL(src);
+	ASSERT_NONNULL(other);
+
+	return other->length == length && memcmp(src, other->buffer, length) == 0;
+}
+
 bool string_equals_string(String* src, String* other) {
 	ASSERT_NONNULL(other);
 	return string_equals(src, other->buffer);
@@ -7,6 +7,11 @@
  * @Member char* buffer: null terminated heap allocated buffer
  * @Member size_t length: length of string not including null terminator 
  * @Note String defines an immutable null-terminated string with a predefined length
+ * @Note Strings made by this library keep their contents inline, directly after the struct,
+ * so `buffer` points into the same allocation and a string costs one malloc and one free.
+ * Two kinds are exceptions: strings from `string_builder_build_move()` keep the builder's
+ * separate buffer along with its spare capacity, which `string_free()` releases as well, and
+ * strings interned in a StringPool share one allocation with their hash and are freed by the pool
  */
 typedef struct {
 	char* buffer;
@@ -15,6 +20,16 @@ typedef struct {
 
 OPTION_TYPE(String*, String, string, NULL)
 
+/**
+ * @Type String
+ * @Param size_t length: number of characters the string holds
+ * @Returns String*: a heap-allocated string whose buffer is null terminated but otherwise uninitialized
+ * @Note The buffer is stored inline after the struct, so the string is a single allocation,
+ * unlike the strings `string_builder_build_move()` returns.
+ * The caller fills the buffer before sharing the string, after which it is immutable
+ */
+String* string_allocate(size_t length);
+
 /**
  * @Type String
  * @Returns String: a heap allocated string with only a null terminator
@@ -30,11 +45,51 @@ String* string_empty();
 
 String* string_from(char* src);
 
+/**
+ * @Type String
+ * @Param Arena* arena: arena in which the string is stored
+ * @Param char* src: parameter from which to build the string
+ * @Returns String*: a null-terminated immutable string whose struct and buffer are a single arena push
+ * @Note The string must not be passed to `string_free()`, it is released with the arena
+ */
+String* string_from_arena(Arena* arena, char* src);
+
+/**
+ * @Type String
+ * @Param Arena* arena: arena in which the string is stored
+ * @Param char* source: source to substringed
+ * @Param size_t start: inclusive substring start
+ * @Param size_t count: number of characters after start
+ * @Returns String*: a string from a sub length of a cstring stored in the arena
+ * @Note The string must not be passed to `string_free()`, it is released with the arena
+ */
+String* string_sub_cstring_arena(Arena* arena, char* source, size_t start, size_t count);
+
+/**
+ * @Type String
+ * @Param Allocator* allocator: allocator through which the string is allocated
+ * @Param char* src: parameter from which to build the string
+ * @Returns String*: a null-terminated immutable string whose struct and buffer are a single allocation
+ * @Note The string must be freed with `string_free_with()` and the same allocator
+ */
+String* string_from_with(Allocator* allocator, char* src);
+
+/**
+ * @Type String
+ * @Param Allocator* allocator: allocator through which the string is allocated
+ * @Param char* source: source to substringed
+ * @Param size_t start: inclusive substring start
+ * @Param size_t count: number of characters after start
+ * @Returns String*: a string from a sub length of a cstring as a single allocation
+ * @Note The string must be freed with `string_free_with()` and the same allocator
+ */
+String* string_sub_cstring_with(Allocator* allocator, char* source, size_t start, size_t count);
+
 /**
  * @Type String
  * @Param char* format: format string with which to format the varargs
- * @Param varargs: arguments formatted via the format parameter and stdarg.h's vaspring' function
- * @Returns String*: a heap-allocated null-terminated immutable string using stdarg.h's vasprintf` function
+ * @Param varargs: arguments formatted via the format parameter and stdio.h's `vsnprintf` function
+ * @Returns String*: a heap-allocated null-terminated immutable string formatted with stdio.h's `vsnprintf` function
  * @Note This function is helpful for concatenation of strings
  * @Note This function does not mutate nor free the given parameters
  */
@@ -58,6 +113,15 @@ String* string_sub_cstring(char* source, size_t start, size_t count);
  */
 String* string_clone(String* string);
 
+/**
+ * @Type String
+ * @Param Allocator* allocator: allocator through which the clone is allocated
+ * @Param String* string: cloneable string
+ * @Returns String*: a deep clone of the given string as a single allocation
+ * @Note The clone must be freed with `string_free_with()` and the same allocator
+ */
+String* string_clone_with(Allocator* allocator, String* string);
+
 /**
  * @Type String
  * @Param String* string: string to free
@@ -65,6 +129,14 @@ String* string_clone(String* string);
  */
 void string_free(String* string);
 
+/**
+ * @Type String
+ * @Param Allocator* allocator: allocator the string was created with
+ * @Param String* string: string to free
+ * @Note Frees a string created by one of the `_with` constructors
+ */
+void string_free_with(Allocator* allocator, String* string);
+
 /**
  * @Type String
  * @Param String* string: string in which to search
@@ -172,10 +244,33 @@ Vector* string_split(String* string, char delimiter);
 
 /**
  * @Type String
- * Returns a hash of a given string using Dan Bernstein's hash function
+ * Returns a hash of a given string, see `hash_bytes()`.
+ * The seed is random per process, so the hash of a string changes between runs
  */
 size_t string_hash(String* string);
 
+/**
+ * @Type String
+ * Returns the hash of the first `length` characters of a cstring.
+ * This matches `string_hash()` for a String with the same contents, so it can be used
+ * as a ViewHasher for maps with String keys
+ */
+size_t string_hash_cstring(const char* src, size_t length);
+
+/**
+ * @Type String
+ * Returns a hash of a given string keyed with the secret per process key, see `hash_siphash()`.
+ * Maps whose keys come from untrusted input should use this hasher rather than `string_hash()`
+ */
+size_t string_hash_keyed(String* string);
+
+/**
+ * @Type String
+ * Returns the keyed hash of the first `length` characters of a cstring.
+ * This matches `string_hash_keyed()` for a String with the same contents
+ */
+size_t string_hash_cstring_keyed(const char* src, size_t length);
+
 /**
  * @Type String
  * Returns true if the string contains one or more instances of the given character
@@ -202,6 +297,13 @@ bool string_equals(String* string, char* other);
  */
 bool string_equals_ignore_case(String* string, char* other);
 
+/**
+ * @Type String
+ * Returns true if the first `length` characters of the cstring equal the string exactly.
+ * This can be used as a ViewEqualityChecker for maps with String keys
+ */
+bool string_equals_cstring(const char* src, size_t length, String* other);
+
 /**
  * @Type String
  * A wrapper function for `string_equals()`
@@ -1,17 +1,39 @@
+#define MEMORY_SUBSYSTEM MEMORY_STRING
 #include "string_builder.h"
 #include "../memory/memory.h"
 #include "string.h"
+#include "string_number.h"
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 
 void _string_builder_expand(StringBuilder* builder, size_t added);
+size_t _string_builder_digits(uint64_t value);
+
+static const char STRING_BUILDER_DIGIT_PAIRS[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
 
 StringBuilder* string_builder_new() {
-	StringBuilder* builder = (StringBuilder*) allocate(sizeof(StringBuilder));
-	(*builder).buffer = allocate(sizeof(char) * 1);
+	return string_builder_new_with(allocator_default());
+}
+
+StringBuilder* string_builder_new_with(Allocator* allocator) {
+	ASSERT_NONNULL(allocator);
+
+	StringBuilder* builder = (StringBuilder*) allocator_allocate(allocator, sizeof(StringBuilder));
+	(*builder).buffer = allocator_allocate(allocator, sizeof(char) * STRING_BUILDER_INITIAL_CAPACITY);
 	(*builder).length = 0;
-	(*builder).capacity = 1;
+	(*builder).capacity = STRING_BUILDER_INITIAL_CAPACITY;
+	(*builder).allocator = allocator;
 
 	return builder;
 }
@@ -25,6 +47,7 @@ StringBuilder* string_builder_from(char* buffer) {
 	builder->buffer = allocate(sizeof(char) * length);
 	builder->length = length;
 	builder->capacity = length;
+	builder->allocator = allocator_default();
 
 	strncpy(builder->buffer, buffer, length);	
 
@@ -34,10 +57,11 @@ StringBuilder* string_builder_from(char* buffer) {
 StringBuilder* string_builder_clone(StringBuilder* src) {
 	ASSERT_NONNULL(src);
 	
-	StringBuilder* copy = (StringBuilder*) allocate(sizeof(StringBuilder));
-	copy->buffer = allocate(sizeof(char) * src->length);
+	StringBuilder* copy = (StringBuilder*) allocator_allocate(src->allocator, sizeof(StringBuilder));
+	copy->buffer = allocator_allocate(src->allocator, sizeof(char) * src->capacity);
 	copy->length = src->length;
 	copy->capacity = src->capacity;
+	copy->allocator = src->allocator;
 
 	strncpy(copy->buffer, src->buffer, src->length);
 
@@ -47,8 +71,14 @@ StringBuilder* string_builder_clone(StringBuilder* src) {
 void string_builder_free(StringBuilder* builder) {
 	ASSERT_NONNULL(builder);	
 
-	free(builder->buffer);
-	free(builder);
+	allocator_free(builder->allocator, builder->buffer, builder->capacity);
+	allocator_free(builder->allocator, builder, sizeof(StringBuilder));
+}
+
+void string_builder_reserve(StringBuilder* builder, size_t additional) {
+	ASSERT_NONNULL(builder);
+
+	_string_builder_expand(builder, additional);
 }
 
 void string_builder_append_char(StringBuilder* builder, char appended) {
@@ -74,13 +104,80 @@ void string_builder_append_format(StringBuilder* builder, char* format, ...) {
 	ASSERT_NONNULL(builder); 
 	ASSERT_NONNULL(format); 
 
-    va_list args;
-    va_start(args, format);
-    String* formatted = string_from_format(format, args);
-    va_end(args);
+	va_list args;
+	va_start(args, format);
+	string_builder_append_vformat(builder, format, args);
+	va_end(args);
+}
+
+void string_builder_append_vformat(StringBuilder* builder, char* format, va_list args) {
+	ASSERT_NONNULL(builder); 
+	ASSERT_NONNULL(format); 
 
-	string_builder_append(builder, formatted->buffer);
-	string_free(formatted);
+	va_list retry;
+	va_copy(retry, args);
+
+	// vsnprintf also writes a null terminator, which is why it needs one byte more than it appends
+	size_t spare = builder->capacity - builder->length;
+	int length = vsnprintf(builder->buffer + builder->length, spare, format, args);
+	ASSERT_INT_GREATER(length + 1, 0);
+
+	if ((size_t) length >= spare) {
+		_string_builder_expand(builder, (size_t) length + 1);
+		vsnprintf(builder->buffer + builder->length, (size_t) length + 1, format, retry);
+	}
+
+	va_end(retry);
+	builder->length += (size_t) length;
+}
+
+void string_builder_append_i64(StringBuilder* builder, int64_t value) {
+	ASSERT_NONNULL(builder);
+
+	if (value < 0) {
+		string_builder_append_char(builder, '-');
+
+		// negating in unsigned arithmetic is also correct for INT64_MIN
+		string_builder_append_u64(builder, (uint64_t) 0 - (uint64_t) value);
+		return;
+	}
+
+	string_builder_append_u64(builder, (uint64_t) value);
+}
+
+void string_builder_append_u64(StringBuilder* builder, uint64_t value) {
+	ASSERT_NONNULL(builder);
+
+	size_t digits = _string_builder_digits(value);
+	_string_builder_expand(builder, digits);
+
+	char* end = builder->buffer + builder->length + digits;
+	builder->length += digits;
+
+	while (value >= 100) {
+		end -= 2;
+		memcpy(end, &STRING_BUILDER_DIGIT_PAIRS[(value % 100) * 2], 2);
+		value /= 100;
+	}
+
+	if (value >= 10) {
+		memcpy(end - 2, &STRING_BUILDER_DIGIT_PAIRS[value * 2], 2);
+	} else {
+		end[-1] = (char) ('0' + value);
+	}
+}
+
+void string_builder_append_f64(StringBuilder* builder, double value) {
+	ASSERT_NONNULL(builder);
+
+	_string_builder_expand(builder, STRING_F64_MAX_LENGTH);
+	builder->length += string_format_f64(value, builder->buffer + builder->length);
+}
+
+void string_builder_clear(StringBuilder* builder) {
+	ASSERT_NONNULL(builder);
+
+	builder->length = 0;
 }
 
 
@@ -97,12 +194,30 @@ void string_builder_append_substring(StringBuilder* builder, char* src, size_t s
 String* string_builder_build(StringBuilder* builder) {
 	ASSERT_NONNULL(builder);
 	
+	String* built = string_allocate(builder->length);
+	memcpy(built->buffer, builder->buffer, builder->length);	
+
+	return built;
+}
+
+String* string_builder_build_move(StringBuilder* builder) {
+	ASSERT_NONNULL(builder);
+
+	if (builder->allocator != allocator_default()) {
+		String* built = string_builder_build(builder);
+		string_builder_free(builder);
+		return built;
+	}
+
+	// strings are null terminated, which may take the one reallocation this makes
+	_string_builder_expand(builder, 1);
+	builder->buffer[builder->length] = '\0';
+
 	String* built = allocate(sizeof(String));
-	built->buffer = allocate(sizeof(char) * (builder->length + 1));
+	built->buffer = builder->buffer;
 	built->length = builder->length;
 
-	strncpy(built->buffer, builder->buffer, builder->length);	
-	strncpy(built->buffer + builder->length , "\0", 1);
+	allocator_free(builder->allocator, builder, sizeof(StringBuilder));
 
 	return built;
 }
@@ -115,15 +230,26 @@ void _string_builder_expand(StringBuilder* builder, size_t added) {
 	}
 
 	if (builder->capacity < (builder->length + added)) {
-		if (added > builder->length) {
+		size_t old_capacity = builder->capacity;
+
+		// doubling keeps appends amortized O(1) however small each one is
+		builder->capacity = old_capacity * 2;
+
+		if (builder->capacity < builder->length + added) {
 			builder->capacity = builder->length + added;
-		} else {
-			builder->capacity = builder->length * 2;
 		}
-		builder->buffer = reallocate(builder->buffer, builder->capacity);	
+
+		builder->buffer = allocator_reallocate(builder->allocator, builder->buffer, old_capacity, builder->capacity);	
 	}
 }
 
+// Counts four digits per division, then the rest by comparison
+size_t _string_builder_digits(uint64_t value) {
+	size_t digits = 1;
 
+	for (; value >= 10000; value /= 10000) {
+		digits += 4;
+	}
 
-
+	return digits + (value >= 10) + (value >= 100) + (value >= 1000);
+}
@@ -1,18 +1,33 @@
 #ifndef NORMALC_STRING_BUILDER_H
 #define NORMALC_STRING_BUILDER_H
 
+#include <stdarg.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include "../error/error.h"
 #include "../safety/option.h"
 #include "string.h"
+#include "../memory/allocator.h"
+
+#ifndef STRING_BUILDER_INITIAL_CAPACITY
+
+/**
+ * STRING_BUILDER_INITIAL_CAPACITY is the buffer size of a new string builder.
+ * Builders double their capacity whenever an append does not fit, so building n characters
+ * takes O(log n) reallocations.
+ */
+#define STRING_BUILDER_INITIAL_CAPACITY 16
+#endif
 
 /**
- * StringBuilder define a mutable non-null terminated string
+ * StringBuilder define a mutable non-null terminated string.
+ * The builder and its buffer are allocated through "allocator"
  */
 typedef struct {
 	char* buffer;
 	size_t length;
 	size_t capacity;
+	Allocator* allocator;
 } StringBuilder;
 
 OPTION_TYPE(StringBuilder*, StringBuilder, string_builder, NULL)
@@ -21,14 +36,65 @@ OPTION_TYPE(StringBuilder*, StringBuilder, string_builder, NULL)
  * Constructs a new heap allocated string builder
  */
 StringBuilder* string_builder_new();
+
+/**
+ * Constructs a new string builder allocated through the given allocator.
+ * Strings built from it are still heap allocated
+ */
+StringBuilder* string_builder_new_with(Allocator* allocator);
 StringBuilder* string_builder_from(char* buffer);
 StringBuilder* string_builder_clone(StringBuilder* src);
 void string_builder_free(StringBuilder* builder);
 
+/**
+ * Ensures the builder can take at least "additional" more characters without reallocating.
+ * Reserving the final size up front makes every later append a plain copy
+ */
+void string_builder_reserve(StringBuilder* builder, size_t additional);
+
 void string_builder_append(StringBuilder* builder, char* appended);
 void string_builder_append_char(StringBuilder* builder, char appended);
 void string_builder_append_substring(StringBuilder* builder, char* src, size_t start, size_t length);
+
+/**
+ * Appends printf style formatted text straight into the builder's spare capacity.
+ * Nothing is allocated unless the text does not fit, in which case the builder grows once and formats again
+ */
 void string_builder_append_format(StringBuilder* builder, char* format, ...);
+
+/**
+ * Same as `string_builder_append_format()` with an argument list
+ */
+void string_builder_append_vformat(StringBuilder* builder, char* format, va_list args);
+
+/**
+ * Appends the decimal digits of an integer, two at a time from a lookup table, without going through printf
+ */
+void string_builder_append_i64(StringBuilder* builder, int64_t value);
+
+/**
+ * Same as `string_builder_append_i64()` for unsigned integers
+ */
+void string_builder_append_u64(StringBuilder* builder, uint64_t value);
+
+/**
+ * Appends the shortest decimal that reads back as the same double, see `string_format_f64()`
+ */
+void string_builder_append_f64(StringBuilder* builder, double value);
+
+/**
+ * Empties the builder while keeping its capacity, so it can be reused without allocating
+ */
+void string_builder_clear(StringBuilder* builder);
+
 String* string_builder_build(StringBuilder* builder);
 
+/**
+ * Builds a string that takes over the builder's buffer instead of copying it, and frees the builder.
+ * The buffer is a separate allocation and keeps the builder's spare capacity, up to as much again
+ * as the contents after geometric growth; use `string_builder_build()` for a compact string.
+ * A builder made with a custom allocator cannot hand its buffer to a String, so its contents are copied
+ */
+String* string_builder_build_move(StringBuilder* builder);
+
 #endif
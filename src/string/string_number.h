@@ -0,0 +1,69 @@
+#ifndef NORMALC_STRING_NUMBER_H
+#define NORMALC_STRING_NUMBER_H
+
+#include <stdint.h>
+#include "string.h"
+#include "../error/error.h"
+
+/**
+ * Maximum number of characters `string_format_f64()` writes, such as "-2.2250738585072014e-308"
+ */
+#define STRING_F64_MAX_LENGTH 25
+
+/**
+ * @Type String
+ * @Param String* string: decimal integer with an optional leading '+' or '-' and nothing else
+ * @Param int64_t* result: set to the parsed value on success, untouched otherwise
+ * @Returns Error: OK, BAD_FORMAT if the string is not a whole integer, or BAD_RANGE if it does not fit
+ * @Note Digits are checked and converted eight at a time, and no locale is consulted
+ */
+Error string_parse_i64(String* string, int64_t* result);
+
+/**
+ * @Type String
+ * @Note Same as `string_parse_i64()` over the first `length` characters of a cstring or view
+ */
+Error string_parse_i64_cstring(const char* src, size_t length, int64_t* result);
+
+/**
+ * @Type String
+ * @Param String* string: decimal integer with an optional leading '+' and nothing else
+ * @Param uint64_t* result: set to the parsed value on success, untouched otherwise
+ * @Returns Error: OK, BAD_FORMAT if the string is not a whole integer, or BAD_RANGE if it does not fit
+ */
+Error string_parse_u64(String* string, uint64_t* result);
+
+/**
+ * @Type String
+ * @Note Same as `string_parse_u64()` over the first `length` characters of a cstring or view
+ */
+Error string_parse_u64_cstring(const char* src, size_t length, uint64_t* result);
+
+/**
+ * @Type String
+ * @Param String* string: decimal number such as "-12.5e3", "inf" or "nan", and nothing else
+ * @Param double* result: set to the nearest double on success, untouched otherwise
+ * @Returns Error: OK, BAD_FORMAT if the string is not a whole number, or BAD_RANGE if it overflows a double
+ * @Note The decimal point is always '.', whatever the locale. Numbers of up to 19 significant
+ * digits whose digits form an integer of at most 2^53, scaled by a power of ten between 1e-22
+ * and 1e22, are converted exactly without calling strtod
+ */
+Error string_parse_f64(String* string, double* result);
+
+/**
+ * @Type String
+ * @Note Same as `string_parse_f64()` over the first `length` characters of a cstring or view
+ */
+Error string_parse_f64_cstring(const char* src, size_t length, double* result);
+
+/**
+ * @Param double value: value to print
+ * @Param char* buffer: receives at most STRING_F64_MAX_LENGTH characters, not null terminated
+ * @Returns size_t: the number of characters written
+ * @Note Prints the fewest digits that still read back as the same double, using Schubfach.
+ * When several decimals of that length read back, the one closest to the value is printed.
+ * Magnitudes from 1e-6 up to 1e21 print as decimals ("0.1", "1500"), others in exponent form ("1e+300")
+ */
+size_t string_format_f64(double value, char* buffer);
+
+#endif
@@ -0,0 +1,151 @@
+#define MEMORY_SUBSYSTEM MEMORY_STRING
+#include "string_pool.h"
+#include "../error/error.h"
+#include <string.h>
+
+_Static_assert(STRING_POOL_SHARDS > 0 && (STRING_POOL_SHARDS & (STRING_POOL_SHARDS - 1)) == 0, "STRING_POOL_SHARDS must be a power of two");
+
+/**
+ * Layout of every interned string: the hash follows the String so the pointer handed out
+ * is still a plain `String*`, and the contents follow both in the same allocation
+ */
+typedef struct {
+	String string;
+	size_t hash;
+} InternedString;
+
+StringPoolShard* _string_pool_shard(StringPool* pool, size_t hash);
+String* _string_pool_intern(StringPool* pool, StringView view, size_t hash);
+void _string_pool_destroy(void* string);
+
+StringPool* string_pool_new() {
+	StringPool* pool = allocate(sizeof(StringPool));
+
+	for (size_t i = 0; i < STRING_POOL_SHARDS; i++) {
+		pool->shards[i].strings = string_pool_map_new(16, destructor_empty, duplicator_empty);
+		pool->shards[i].strings->key_destructor = _string_pool_destroy;
+		pthread_mutex_init(&pool->shards[i].lock, NULL);
+	}
+
+	return pool;
+}
+
+void string_pool_free(StringPool* pool) {
+	ASSERT_NONNULL(pool);
+
+	for (size_t i = 0; i < STRING_POOL_SHARDS; i++) {
+		map_free(pool->shards[i].strings);
+		pthread_mutex_destroy(&pool->shards[i].lock);
+	}
+
+	deallocate(pool);
+}
+
+String* string_pool_intern(StringPool* pool, StringView view) {
+	ASSERT_NONNULL(pool);
+
+	return _string_pool_intern(pool, view, string_view_hash(view));
+}
+
+String* string_pool_intern_cstring(StringPool* pool, char* src) {
+	ASSERT_NONNULL(src);
+
+	return string_pool_intern(pool, string_view_from(src));
+}
+
+void string_pool_intern_all(StringPool* pool, StringView* views, size_t count, String** interned) {
+	ASSERT_NONNULL(pool);
+	ASSERT_NONNULL(views);
+	ASSERT_NONNULL(interned);
+
+	for (size_t i = 0; i < count; i++) {
+		interned[i] = _string_pool_intern(pool, views[i], string_view_hash(views[i]));
+	}
+}
+
+String* string_pool_find(StringPool* pool, StringView view) {
+	ASSERT_NONNULL(pool);
+
+	size_t hash = string_view_hash(view);
+	StringPoolShard* shard = _string_pool_shard(pool, hash);
+
+	pthread_mutex_lock(&shard->lock);
+	String* found = map_get_value_view(shard->strings, view.buffer, view.length, string_hash_cstring, (ViewEqualityChecker) string_equals_cstring);
+	pthread_mutex_unlock(&shard->lock);
+
+	return found;
+}
+
+size_t string_pool_count(StringPool* pool) {
+	ASSERT_NONNULL(pool);
+
+	size_t count = 0;
+
+	for (size_t i = 0; i < STRING_POOL_SHARDS; i++) {
+		pthread_mutex_lock(&pool->shards[i].lock);
+		count += pool->shards[i].strings->entry_count;
+		pthread_mutex_unlock(&pool->shards[i].lock);
+	}
+
+	return count;
+}
+
+size_t string_interned_hash(String* string) {
+	ASSERT_NONNULL(string);
+
+	return ((InternedString*) string)->hash;
+}
+
+bool string_interned_equals(String* string, String* other) {
+	return string == other;
+}
+
+Map* string_pool_map_new(size_t initial_capacity, Destructor value_destructor, Duplicator value_duplicator) {
+	return map_new(
+				initial_capacity,
+				(Hasher) string_interned_hash,
+				(EqualityChecker) string_interned_equals,
+				destructor_empty,
+				value_destructor,
+				duplicator_empty,
+				value_duplicator
+			);
+}
+
+// INTERNAL
+
+StringPoolShard* _string_pool_shard(StringPool* pool, size_t hash) {
+	// the map consumes the low bits, so pick the shard from the high ones
+	return &pool->shards[((hash * 0x9e3779b97f4a7c15ULL) >> 32) & (STRING_POOL_SHARDS - 1)];
+}
+
+String* _string_pool_intern(StringPool* pool, StringView view, size_t hash) {
+	StringPoolShard* shard = _string_pool_shard(pool, hash);
+	pthread_mutex_lock(&shard->lock);
+
+	// a miss stores its entry in the slot the lookup probed, so the string is only built to fill it
+	bool found;
+	Entry* entry = map_claim_view(shard->strings, view.buffer, view.length, string_hash_cstring, (ViewEqualityChecker) string_equals_cstring, &found);
+
+	if (!found) {
+		InternedString* interned = allocate(sizeof(InternedString) + view.length + 1);
+		interned->string.buffer = (char*) (interned + 1);
+		interned->string.length = view.length;
+		interned->hash = hash;
+
+		memcpy(interned->string.buffer, view.buffer, view.length);
+		interned->string.buffer[view.length] = '\0';
+
+		entry->key = &interned->string;
+		entry->value = &interned->string;
+	}
+
+	String* string = entry->value;
+	pthread_mutex_unlock(&shard->lock);
+
+	return string;
+}
+
+void _string_pool_destroy(void* string) {
+	deallocate(string);
+}
@@ -0,0 +1,104 @@
+#ifndef NORMALC_STRING_POOL_H
+#define NORMALC_STRING_POOL_H
+
+#include <pthread.h>
+#include "string.h"
+#include "string_view.h"
+#include "../collections/map.h"
+
+#ifndef STRING_POOL_SHARDS
+/**
+ * Number of independently locked tables in a StringPool. Threads interning different
+ * strings rarely contend for the same lock. Must be a power of two, 1 included.
+ * It sets the size of StringPool, so an override must be the same for the library build
+ * and for all code including this header.
+ */
+#define STRING_POOL_SHARDS 16
+#endif
+
+/**
+ * A single locked table of interned strings
+ */
+typedef struct {
+	Map* strings;
+	pthread_mutex_t lock;
+} StringPoolShard;
+
+/**
+ * StringPool interns strings: for each distinct content it hands out one canonical `String*`
+ * that lives until the pool is freed. Interned strings carry their hash, so they hash in O(1)
+ * and two interned strings from the same pool are equal exactly when their pointers are.
+ *
+ * Every function is safe to call from multiple threads at once.
+ */
+typedef struct {
+	StringPoolShard shards[STRING_POOL_SHARDS];
+} StringPool;
+
+/**
+ * @Type StringPool
+ * @Returns StringPool*: a new empty pool
+ */
+StringPool* string_pool_new();
+
+/**
+ * @Type StringPool
+ * @Note Frees the pool and every string interned in it
+ */
+void string_pool_free(StringPool* pool);
+
+/**
+ * @Type StringPool
+ * @Param StringView view: contents to intern, which are copied on first sight
+ * @Returns String*: the canonical string with the given contents
+ * @Note The returned string is owned by the pool and must not be freed
+ */
+String* string_pool_intern(StringPool* pool, StringView view);
+
+/**
+ * @Type StringPool
+ * @Note Same as `string_pool_intern()` for a cstring
+ */
+String* string_pool_intern_cstring(StringPool* pool, char* src);
+
+/**
+ * @Type StringPool
+ * @Param StringView* views: contents to intern
+ * @Param size_t count: number of views
+ * @Param String** interned: filled with the canonical string of each view
+ */
+void string_pool_intern_all(StringPool* pool, StringView* views, size_t count, String** interned);
+
+/**
+ * @Type StringPool
+ * @Returns String*: the canonical string with the given contents, or null if it was never interned
+ */
+String* string_pool_find(StringPool* pool, StringView view);
+
+/**
+ * @Type StringPool
+ * @Returns size_t: the number of distinct strings in the pool
+ */
+size_t string_pool_count(StringPool* pool);
+
+/**
+ * @Type StringPool
+ * @Param String* string: string returned by a StringPool
+ * @Returns size_t: the hash stored at interning, equal to `string_hash()` of the string
+ */
+size_t string_interned_hash(String* string);
+
+/**
+ * @Type StringPool
+ * @Returns bool: true if both strings from the same pool hold the same contents, by pointer comparison
+ */
+bool string_interned_equals(String* string, String* other);
+
+/**
+ * Creates a map keyed by strings interned in a StringPool. Keys are hashed with their stored
+ * hash and compared by pointer, and are neither freed nor cloned since the pool owns them.
+ * Keys must be interned in the same pool before inserting or looking up.
+ */
+Map* string_pool_map_new(size_t initial_capacity, Destructor value_destructor, Duplicator value_duplicator);
+
+#endif
@@ -0,0 +1,299 @@
+#include "string_search.h"
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define STRING_SEARCH_WIDTH 32
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define STRING_SEARCH_WIDTH 16
+#endif
+
+size_t _string_search_filter(const char* haystack, size_t length, const char* needle, size_t needle_length);
+size_t _string_search_filter_last(const char* haystack, size_t length, const char* needle, size_t needle_length);
+size_t _string_search_horspool(const char* haystack, size_t length, const char* needle, size_t needle_length);
+size_t _string_search_horspool_last(const char* haystack, size_t length, const char* needle, size_t needle_length);
+static inline uint32_t _string_search_select(uint32_t matches, size_t n);
+
+#ifdef STRING_SEARCH_WIDTH
+static inline uint32_t _string_search_match(const char* block, char query);
+static inline uint32_t _string_search_match_pair(const char* first_block, const char* last_block, char first, char last);
+#endif
+
+size_t string_search(const char* haystack, size_t length, const char* needle, size_t needle_length) {
+	if (needle_length == 0 || needle_length > length) {
+		return STRING_SEARCH_NOT_FOUND;
+	}
+
+	if (needle_length == 1) {
+		const char* found = memchr(haystack, needle[0], length);
+		return found != NULL ? (size_t) (found - haystack) : STRING_SEARCH_NOT_FOUND;
+	}
+
+	if (needle_length >= STRING_SEARCH_HORSPOOL_MIN) {
+		return _string_search_horspool(haystack, length, needle, needle_length);
+	}
+
+	return _string_search_filter(haystack, length, needle, needle_length);
+}
+
+size_t string_search_last(const char* haystack, size_t length, const char* needle, size_t needle_length) {
+	if (needle_length == 0 || needle_length > length) {
+		return STRING_SEARCH_NOT_FOUND;
+	}
+
+	if (needle_length == 1) {
+		return string_search_nth_byte_last(haystack, length, 1, needle[0]);
+	}
+
+	if (needle_length >= STRING_SEARCH_HORSPOOL_MIN) {
+		return _string_search_horspool_last(haystack, length, needle, needle_length);
+	}
+
+	return _string_search_filter_last(haystack, length, needle, needle_length);
+}
+
+size_t string_search_nth_byte(const char* haystack, size_t length, size_t n, char query) {
+	size_t i = 0;
+
+	if (n == 0) {
+		n = 1;
+	}
+
+#ifdef STRING_SEARCH_WIDTH
+	// memchr is already vectorized, so counting only pays off while skipping earlier matches
+	for (; n > 1 && i + STRING_SEARCH_WIDTH <= length; i += STRING_SEARCH_WIDTH) {
+		uint32_t matches = _string_search_match(haystack + i, query);
+		size_t count = __builtin_popcount(matches);
+
+		if (count >= n) {
+			return i + __builtin_ctz(_string_search_select(matches, n));
+		}
+
+		n -= count;
+	}
+#endif
+
+	while (i < length) {
+		const char* found = memchr(haystack + i, query, length - i);
+
+		if (found == NULL) {
+			break;
+		}
+
+		if (--n == 0) {
+			return found - haystack;
+		}
+
+		i = found - haystack + 1;
+	}
+
+	return STRING_SEARCH_NOT_FOUND;
+}
+
+size_t string_search_nth_byte_last(const char* haystack, size_t length, size_t n, char query) {
+	size_t end = length;
+
+	if (n == 0) {
+		n = 1;
+	}
+
+#ifdef STRING_SEARCH_WIDTH
+	for (; end >= STRING_SEARCH_WIDTH; end -= STRING_SEARCH_WIDTH) {
+		uint32_t matches = _string_search_match(haystack + end - STRING_SEARCH_WIDTH, query);
+		size_t count = __builtin_popcount(matches);
+
+		if (count >= n) {
+			// the nth match from the top is the (count - n + 1)th from the bottom
+			return end - STRING_SEARCH_WIDTH + __builtin_ctz(_string_search_select(matches, count - n + 1));
+		}
+
+		n -= count;
+	}
+#endif
+
+	for (size_t i = end - 1; i != SIZE_MAX; i--) {
+		if (haystack[i] == query && --n == 0) {
+			return i;
+		}
+	}
+
+	return STRING_SEARCH_NOT_FOUND;
+}
+
+// INTERNAL
+
+// Clears all but the nth lowest set bit onwards, so ctz of the result is the nth match
+static inline uint32_t _string_search_select(uint32_t matches, size_t n) {
+	while (--n > 0) {
+		matches &= matches - 1;
+	}
+
+	return matches;
+}
+
+// Compares the first and last needle byte against a register of candidate starts at once,
+// so memcmp only runs where both ends already match
+size_t _string_search_filter(const char* haystack, size_t length, const char* needle, size_t needle_length) {
+	size_t last_start = length - needle_length;
+	size_t i = 0;
+	char first = needle[0];
+	char last = needle[needle_length - 1];
+
+#ifdef STRING_SEARCH_WIDTH
+	for (; i + STRING_SEARCH_WIDTH - 1 <= last_start; i += STRING_SEARCH_WIDTH) {
+		uint32_t matches = _string_search_match_pair(haystack + i, haystack + i + needle_length - 1, first, last);
+
+		while (matches != 0) {
+			size_t start = i + __builtin_ctz(matches);
+
+			if (memcmp(haystack + start + 1, needle + 1, needle_length - 2) == 0) {
+				return start;
+			}
+
+			matches &= matches - 1;
+		}
+	}
+#endif
+
+	while (i <= last_start) {
+		const char* found = memchr(haystack + i, first, last_start - i + 1);
+
+		if (found == NULL) {
+			break;
+		}
+
+		size_t start = found - haystack;
+
+		if (haystack[start + needle_length - 1] == last && memcmp(found + 1, needle + 1, needle_length - 2) == 0) {
+			return start;
+		}
+
+		i = start + 1;
+	}
+
+	return STRING_SEARCH_NOT_FOUND;
+}
+
+// Same filter as `_string_search_filter()`, walking the candidate blocks from the end
+size_t _string_search_filter_last(const char* haystack, size_t length, const char* needle, size_t needle_length) {
+	// one past the highest candidate start that is still unchecked
+	size_t end = length - needle_length + 1;
+	char first = needle[0];
+	char last = needle[needle_length - 1];
+
+#ifdef STRING_SEARCH_WIDTH
+	for (; end >= STRING_SEARCH_WIDTH; end -= STRING_SEARCH_WIDTH) {
+		size_t block = end - STRING_SEARCH_WIDTH;
+		uint32_t matches = _string_search_match_pair(haystack + block, haystack + block + needle_length - 1, first, last);
+
+		while (matches != 0) {
+			size_t offset = 31 - __builtin_clz(matches);
+
+			if (memcmp(haystack + block + offset + 1, needle + 1, needle_length - 2) == 0) {
+				return block + offset;
+			}
+
+			matches &= ~((uint32_t) 1 << offset);
+		}
+	}
+#endif
+
+	for (size_t start = end - 1; start != SIZE_MAX; start--) {
+		if (haystack[start] == first
+				&& haystack[start + needle_length - 1] == last
+				&& memcmp(haystack + start + 1, needle + 1, needle_length - 2) == 0) {
+			return start;
+		}
+	}
+
+	return STRING_SEARCH_NOT_FOUND;
+}
+
+// Horspool's algorithm: on a mismatch, shift so the haystack byte under the needle's last
+// position lines up with its rightmost occurrence in the needle
+size_t _string_search_horspool(const char* haystack, size_t length, const char* needle, size_t needle_length) {
+	size_t shifts[256];
+
+	for (size_t i = 0; i < 256; i++) {
+		shifts[i] = needle_length;
+	}
+
+	for (size_t i = 0; i < needle_length - 1; i++) {
+		shifts[(unsigned char) needle[i]] = needle_length - 1 - i;
+	}
+
+	char last = needle[needle_length - 1];
+	size_t last_start = length - needle_length;
+
+	for (size_t i = 0; i <= last_start;) {
+		unsigned char current = haystack[i + needle_length - 1];
+
+		if ((char) current == last && memcmp(haystack + i, needle, needle_length - 1) == 0) {
+			return i;
+		}
+
+		i += shifts[current];
+	}
+
+	return STRING_SEARCH_NOT_FOUND;
+}
+
+// Mirror of `_string_search_horspool()` keyed on the byte under the needle's first position
+size_t _string_search_horspool_last(const char* haystack, size_t length, const char* needle, size_t needle_length) {
+	size_t shifts[256];
+
+	for (size_t i = 0; i < 256; i++) {
+		shifts[i] = needle_length;
+	}
+
+	for (size_t i = needle_length - 1; i > 0; i--) {
+		shifts[(unsigned char) needle[i]] = i;
+	}
+
+	char first = needle[0];
+
+	for (size_t i = length - needle_length;;) {
+		unsigned char current = haystack[i];
+
+		if ((char) current == first && memcmp(haystack + i + 1, needle + 1, needle_length - 1) == 0) {
+			return i;
+		}
+
+		if (i < shifts[current]) {
+			return STRING_SEARCH_NOT_FOUND;
+		}
+
+		i -= shifts[current];
+	}
+}
+
+#if defined(__AVX2__)
+
+static inline uint32_t _string_search_match(const char* block, char query) {
+	__m256i bytes = _mm256_loadu_si256((const __m256i*) block);
+	return (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(query)));
+}
+
+static inline uint32_t _string_search_match_pair(const char* first_block, const char* last_block, char first, char last) {
+	__m256i firsts = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) first_block), _mm256_set1_epi8(first));
+	__m256i lasts = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) last_block), _mm256_set1_epi8(last));
+
+	return (uint32_t) _mm256_movemask_epi8(_mm256_and_si256(firsts, lasts));
+}
+
+#elif defined(__SSE2__)
+
+static inline uint32_t _string_search_match(const char* block, char query) {
+	__m128i bytes = _mm_loadu_si128((const __m128i*) block);
+	return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(query)));
+}
+
+static inline uint32_t _string_search_match_pair(const char* first_block, const char* last_block, char first, char last) {
+	__m128i firsts = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) first_block), _mm_set1_epi8(first));
+	__m128i lasts = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) last_block), _mm_set1_epi8(last));
+
+	return (uint32_t) _mm_movemask_epi8(_mm_and_si128(firsts, lasts));
+}
+
+#endif
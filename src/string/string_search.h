@@ -0,0 +1,51 @@
+#ifndef NORMALC_STRING_SEARCH_H
+#define NORMALC_STRING_SEARCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Returned by the search functions when the needle does not occur in the haystack
+ */
+#define STRING_SEARCH_NOT_FOUND SIZE_MAX
+
+#ifndef STRING_SEARCH_HORSPOOL_MIN
+/**
+ * Needles of at least this many bytes are searched with Horspool's algorithm, which skips
+ * up to a full needle length per step. Shorter needles use the SIMD first/last byte filter,
+ * which compares a whole register of candidate positions per step instead.
+ */
+#define STRING_SEARCH_HORSPOOL_MIN 64
+#endif
+
+/**
+ * Returns the index of the first occurrence of needle in haystack.
+ *
+ * Single bytes use memchr. Other needles compare the first and last byte of the needle against
+ * 16 (SSE2) or 32 (AVX2) positions at once and only run memcmp where both match, falling back
+ * to a scalar filter when neither instruction set is enabled at compile time.
+ *
+ * An empty needle is never found.
+ */
+size_t string_search(const char* haystack, size_t length, const char* needle, size_t needle_length);
+
+/**
+ * Returns the index of the last occurrence of needle in haystack, using the same
+ * strategies as `string_search()` while scanning backwards
+ */
+size_t string_search_last(const char* haystack, size_t length, const char* needle, size_t needle_length);
+
+/**
+ * Returns the index of the nth occurrence of query in haystack, with an n of 1 being the first.
+ * Matches are counted a register at a time with popcount, so only the block holding
+ * the nth match is inspected bit by bit. An n of 0 is treated as 1
+ */
+size_t string_search_nth_byte(const char* haystack, size_t length, size_t n, char query);
+
+/**
+ * Returns the index of the nth occurrence of query in haystack counting from the end,
+ * with an n of 1 being the last. An n of 0 is treated as 1
+ */
+size_t string_search_nth_byte_last(const char* haystack, size_t length, size_t n, char query);
+
+#endif
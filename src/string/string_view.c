@@ -0,0 +1,190 @@
+#define MEMORY_SUBSYSTEM MEMORY_STRING
+#include "string_view.h"
+#include "string_search.h"
+#include "../error/error.h"
+#include <ctype.h>
+#include <string.h>
+
+StringView string_view_new(const char* buffer, size_t length) {
+	ASSERT_NONNULL(buffer);
+
+	return (StringView) {
+		.buffer = buffer,
+		.length = length,
+	};
+}
+
+StringView string_view_from(const char* src) {
+	ASSERT_NONNULL(src);
+
+	return string_view_new(src, strlen(src));
+}
+
+StringView string_view_of(String* string) {
+	ASSERT_NONNULL(string);
+
+	return string_view_new(string->buffer, string->length);
+}
+
+String* string_from_view(StringView view) {
+	String* string = string_allocate(view.length);
+	memcpy(string->buffer, view.buffer, view.length);
+
+	return string;
+}
+
+StringView string_view_substring(StringView view, size_t start, size_t count) {
+	if (start > view.length || count > view.length - start) {
+		printf("\nILLEGAL BOUND ERROR: attempted view of %zu characters at index %zu of a view of length %zu\nSee: %s (line %d)\n",
+				count, start, view.length, __FILE__, __LINE__);
+		exit(EXIT_FAILURE);
+	}
+
+	return string_view_new(view.buffer + start, count);
+}
+
+StringView string_view_trim(StringView view) {
+	size_t start = 0;
+	size_t end = view.length;
+
+	while (start < end && isspace((unsigned char) view.buffer[start])) {
+		start++;
+	}
+
+	while (end > start && isspace((unsigned char) view.buffer[end - 1])) {
+		end--;
+	}
+
+	return string_view_new(view.buffer + start, end - start);
+}
+
+int string_view_index_of(StringView view, char query) {
+	size_t index = string_search_nth_byte(view.buffer, view.length, 1, query);
+
+	return index != STRING_SEARCH_NOT_FOUND ? (int) index : -1;
+}
+
+int string_view_index_of_last(StringView view, char query) {
+	size_t index = string_search_nth_byte_last(view.buffer, view.length, 1, query);
+
+	return index != STRING_SEARCH_NOT_FOUND ? (int) index : -1;
+}
+
+int string_view_index_of_view(StringView view, StringView query) {
+	size_t index = string_search(view.buffer, view.length, query.buffer, query.length);
+
+	return index != STRING_SEARCH_NOT_FOUND ? (int) index : -1;
+}
+
+bool string_view_equals(StringView view, StringView other) {
+	return view.length == other.length && memcmp(view.buffer, other.buffer, view.length) == 0;
+}
+
+int string_view_compare(StringView view, StringView other) {
+	size_t shared = view.length < other.length ? view.length : other.length;
+	int compared = memcmp(view.buffer, other.buffer, shared);
+
+	if (compared != 0 || view.length == other.length) {
+		return compared;
+	}
+
+	return view.length < other.length ? -1 : 1;
+}
+
+size_t string_view_hash(StringView view) {
+	return string_hash_cstring(view.buffer, view.length);
+}
+
+size_t string_view_split(StringView view, char delimiter, Array* views) {
+	ASSERT_NONNULL(views);
+
+	if (views->element_size != sizeof(StringView)) {
+		printf("\nILLEGAL ARGUMENT ERROR: views must be an array of %zu byte StringView elements, not %zu\nSee: %s (line %d)\n",
+				sizeof(StringView), views->element_size, __FILE__, __LINE__);
+		exit(EXIT_FAILURE);
+	}
+
+	array_clear(views);
+
+	const char* end = view.buffer + view.length;
+	const char* start = view.buffer;
+
+	while (start < end) {
+		const char* found = memchr(start, delimiter, end - start);
+		const char* stop = found != NULL ? found : end;
+
+		if (stop > start) {
+			StringView part = string_view_new(start, stop - start);
+			array_add(views, &part);
+		}
+
+		start = stop + 1;
+	}
+
+	return views->count;
+}
+
+size_t string_split_views(String* string, char delimiter, Array* views) {
+	return string_view_split(string_view_of(string), delimiter, views);
+}
+
+StringSplitIter string_split_iter(StringView view, char delimiter, bool keep_empty) {
+	StringSplitIter iter = string_split_iter_view(view, string_view_new(&delimiter, 1), keep_empty);
+
+	// a single byte is kept in the iterator itself, so the caller has nothing to keep alive
+	iter.delimiter = NULL;
+	iter.byte = delimiter;
+
+	return iter;
+}
+
+StringSplitIter string_split_iter_view(StringView view, StringView delimiter, bool keep_empty) {
+	ASSERT_INT_GREATER((int) delimiter.length, 0);
+
+	return (StringSplitIter) {
+		.cursor = view.buffer,
+		.end = view.buffer + view.length,
+		.delimiter = delimiter.buffer,
+		.delimiter_length = delimiter.length,
+		.byte = delimiter.buffer[0],
+		.keep_empty = keep_empty,
+		.finished = false,
+	};
+}
+
+bool string_split_iter_next(StringSplitIter* iter, StringView* part) {
+	ASSERT_NONNULL(iter);
+	ASSERT_NONNULL(part);
+
+	while (!iter->finished) {
+		size_t remaining = iter->end - iter->cursor;
+		const char* found;
+
+		if (iter->delimiter_length == 1) {
+			found = memchr(iter->cursor, iter->byte, remaining);
+		} else {
+			size_t index = string_search(iter->cursor, remaining, iter->delimiter, iter->delimiter_length);
+			found = index != STRING_SEARCH_NOT_FOUND ? iter->cursor + index : NULL;
+		}
+
+		const char* start = iter->cursor;
+		const char* stop = found != NULL ? found : iter->end;
+
+		if (found != NULL) {
+			iter->cursor = found + iter->delimiter_length;
+		} else {
+			iter->finished = true;
+		}
+
+		if (stop > start || iter->keep_empty) {
+			*part = (StringView) {
+				.buffer = start,
+				.length = stop - start,
+			};
+
+			return true;
+		}
+	}
+
+	return false;
+}
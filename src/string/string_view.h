@@ -0,0 +1,165 @@
+#ifndef NORMALC_STRING_VIEW_H
+#define NORMALC_STRING_VIEW_H
+
+#include "string.h"
+#include "../collections/array.h"
+
+/**
+ * @Member const char* buffer: borrowed characters, not null terminated
+ * @Member size_t length: number of characters in the view
+ * @Note StringView defines a non-owning slice of a String or cstring.
+ * Views are passed by value, never freed, and only valid while the memory they borrow is.
+ */
+typedef struct {
+	const char* buffer;
+	size_t length;
+} StringView;
+
+#define DEFAULT_STRING_VIEW { NULL, 0 }
+OPTION_TYPE(StringView, StringView, string_view, DEFAULT_STRING_VIEW)
+
+/**
+ * @Type StringView
+ * @Param const char* buffer: characters to borrow
+ * @Param size_t length: number of characters to borrow
+ * @Returns StringView: a view of the given characters
+ */
+StringView string_view_new(const char* buffer, size_t length);
+
+/**
+ * @Type StringView
+ * @Param const char* src: null terminated characters to borrow
+ * @Returns StringView: a view of the cstring without its null terminator
+ */
+StringView string_view_from(const char* src);
+
+/**
+ * @Type StringView
+ * @Param String* string: string to borrow
+ * @Returns StringView: a view of the whole string
+ */
+StringView string_view_of(String* string);
+
+/**
+ * @Type StringView
+ * @Param StringView view: viewed characters to copy
+ * @Returns String*: a heap-allocated null-terminated copy of the view
+ */
+String* string_from_view(StringView view);
+
+/**
+ * @Type StringView
+ * @Param StringView view: view to slice
+ * @Param size_t start: inclusive start of the slice
+ * @Param size_t count: number of characters after start
+ * @Returns StringView: a view of a part of the given view
+ * @Note If the given start and count are outside the view, the system will exit with an error
+ */
+StringView string_view_substring(StringView view, size_t start, size_t count);
+
+/**
+ * @Type StringView
+ * @Returns StringView: the view without leading and trailing whitespace
+ */
+StringView string_view_trim(StringView view);
+
+/**
+ * @Type StringView
+ * @Returns int: the first index of query in the view, or -1 if none can be found
+ */
+int string_view_index_of(StringView view, char query);
+
+/**
+ * @Type StringView
+ * @Returns int: the last index of query in the view, or -1 if none can be found
+ */
+int string_view_index_of_last(StringView view, char query);
+
+/**
+ * @Type StringView
+ * @Returns int: the first index of query in the view, or -1 if none can be found or query is empty
+ */
+int string_view_index_of_view(StringView view, StringView query);
+
+/**
+ * @Type StringView
+ * @Returns bool: true if both views hold the same characters
+ */
+bool string_view_equals(StringView view, StringView other);
+
+/**
+ * @Type StringView
+ * @Returns int: 0 if equal, negative if view sorts before other, positive if after
+ * @Note Shorter views sort before longer views they are a prefix of
+ */
+int string_view_compare(StringView view, StringView other);
+
+/**
+ * @Type StringView
+ * @Returns size_t: a hash equal to `string_hash()` of a String with the same characters,
+ * so views can look up String keys with `map_get_value_view()`
+ */
+size_t string_view_hash(StringView view);
+
+/**
+ * @Type StringView
+ * @Param StringView view: view to split
+ * @Param char delimiter: character separating the parts
+ * @Param Array* views: array of `sizeof(StringView)` elements which is cleared then filled with the parts
+ * @Returns size_t: the number of parts
+ * @Note Parts follow `string_split()`: repeated delimiters produce no empty parts.
+ * Nothing is allocated once the array has grown to the number of parts, so it can be reused across calls
+ */
+size_t string_view_split(StringView view, char delimiter, Array* views);
+
+/**
+ * @Type StringView
+ * @Note Same as `string_view_split()` over the whole string
+ */
+size_t string_split_views(String* string, char delimiter, Array* views);
+
+/**
+ * StringSplitIter lazily splits a view, yielding one part per call to `string_split_iter_next()`.
+ * It holds no memory of its own, so streaming over any amount of input costs constant memory
+ * and the caller can stop at any part.
+ *
+ * Without "keep_empty", repeated delimiters yield no empty parts like `string_split()`.
+ * With it, every delimiter separates two fields, so "a,,b," yields "a", "", "b" and "".
+ */
+typedef struct {
+	const char* cursor;
+	const char* end;
+	const char* delimiter;
+	size_t delimiter_length;
+	char byte;
+	bool keep_empty;
+	bool finished;
+} StringSplitIter;
+
+/**
+ * @Type StringSplitIter
+ * @Param StringView view: view to split, which must outlive the iterator
+ * @Param char delimiter: character separating the parts
+ * @Param bool keep_empty: whether empty parts between delimiters are yielded
+ * @Returns StringSplitIter: an iterator over the parts of the view
+ */
+StringSplitIter string_split_iter(StringView view, char delimiter, bool keep_empty);
+
+/**
+ * @Type StringSplitIter
+ * @Param StringView view: view to split, which must outlive the iterator
+ * @Param StringView delimiter: non-empty sequence separating the parts, which must outlive the iterator
+ * @Param bool keep_empty: whether empty parts between delimiters are yielded
+ * @Returns StringSplitIter: an iterator over the parts of the view
+ */
+StringSplitIter string_split_iter_view(StringView view, StringView delimiter, bool keep_empty);
+
+/**
+ * @Type StringSplitIter
+ * @Param StringSplitIter* iter: iterator to advance
+ * @Param StringView* part: set to the next part
+ * @Returns bool: false once every part has been yielded, leaving part untouched
+ */
+bool string_split_iter_next(StringSplitIter* iter, StringView* part);
+
+#endif
@@ -0,0 +1,170 @@
+#include <normalc/memory/allocator.h>
+#include <normalc/collections/vector.h>
+#include <normalc/collections/array.h>
+#include <normalc/collections/linked_list.h>
+#include <normalc/collections/map.h>
+#include <normalc/string/string.h>
+#include <normalc/string/string_builder.h>
+#include <stdio.h>
+
+void test_vector();
+void test_map();
+void test_list();
+void test_strings();
+
+/**
+ * Counts live allocations and bytes so every container can be checked for leaks
+ */
+typedef struct {
+	size_t allocations;
+	size_t bytes;
+} Counter;
+
+void* _counter_allocate(void* context, size_t size) {
+	Counter* counter = context;
+	counter->allocations++;
+	counter->bytes += size;
+
+	return allocate(size);
+}
+
+void* _counter_reallocate(void* context, void* pointer, size_t old_size, size_t new_size) {
+	Counter* counter = context;
+	counter->bytes += new_size - old_size;
+
+	return reallocate(pointer, new_size);
+}
+
+void _counter_free(void* context, void* pointer, size_t size) {
+	Counter* counter = context;
+	counter->allocations--;
+	counter->bytes -= size;
+
+	deallocate(pointer);
+}
+
+Counter COUNTER = { 0, 0 };
+Allocator COUNTING = { _counter_allocate, _counter_reallocate, _counter_free, &COUNTER };
+
+int main() {
+	test_vector();
+	test_map();
+	test_list();
+	test_strings();
+	return 0;
+}
+
+void _print_counter(char* label) {
+	printf("%s: %zu allocations, %zu bytes\n", label, COUNTER.allocations, COUNTER.bytes);
+}
+
+void test_vector() {
+	printf("\n--TEST ALLOCATOR VECTOR--\n\n");
+
+	Vector* vector = vector_new_with(1, duplicator_empty, destructor_empty, &COUNTING);
+	size_t elements[100];
+
+	for (size_t i = 0; i < 100; i++) {
+		elements[i] = i;
+		vector_add(vector, &elements[i]);
+	}
+
+	Vector* clone = vector_clone(vector);
+	_print_counter("Live vectors");
+
+	vector_free(vector);
+	vector_free(clone);
+	_print_counter("Freed vectors");
+
+	Array* array = array_new_with(16, sizeof(size_t), &COUNTING);
+
+	for (size_t i = 0; i < 100; i++) {
+		array_add(array, &i);
+	}
+
+	_print_counter("Live array");
+	array_free(array);
+	_print_counter("Freed array");
+}
+
+size_t _string_hash(String* key) {
+	return string_hash(key);
+}
+
+void test_map() {
+	printf("\n--TEST ALLOCATOR MAP--\n\n");
+
+	Map* map = map_new_with(
+				1,
+				(Hasher) _string_hash,
+				(EqualityChecker) string_equals_string,
+				(Destructor) string_free,
+				(Destructor) string_free,
+				(Duplicator) string_clone,
+				(Duplicator) string_clone,
+				&COUNTING
+			);
+
+	for (size_t i = 0; i < 1000; i++) {
+		String* key = string_from_format("key%zu", i);
+		map_insert(map, key, string_clone(key));
+	}
+
+	Map* clone = map_clone(map);
+	map_delete(map, &(String) { "key1", 4 }, false);
+
+	printf("Entries: %zu, clone entries: %zu\n", map->entry_count, clone->entry_count);
+	_print_counter("Live maps");
+
+	MapSplice splice = map_splice_from(map);
+	map_splice_free(&splice);
+
+	map_free(map);
+	map_free(clone);
+	_print_counter("Freed maps");
+}
+
+void test_list() {
+	printf("\n--TEST ALLOCATOR LINKED LIST--\n\n");
+
+	String* element = string_from("Element");
+	LinkedList* list = linked_list_new_with(
+				linked_node_new_with(element, NULL, &COUNTING),
+				destructor_empty,
+				duplicator_empty,
+				&COUNTING
+			);
+
+	for (size_t i = 0; i < 10; i++) {
+		linked_list_push(list, linked_node_new_with(element, NULL, &COUNTING));
+	}
+
+	LinkedList* clone = linked_list_clone(list);
+	_print_counter("Live lists");
+
+	linked_list_free(list);
+	linked_list_free(clone);
+	string_free(element);
+	_print_counter("Freed lists");
+}
+
+void test_strings() {
+	printf("\n--TEST ALLOCATOR STRINGS--\n\n");
+
+	StringBuilder* builder = string_builder_new_with(&COUNTING);
+
+	for (size_t i = 0; i < 10; i++) {
+		string_builder_append(builder, "Hello ");
+	}
+
+	String* string = string_from_with(&COUNTING, "Hello World");
+	String* clone = string_clone_with(&COUNTING, string);
+
+	printf("Clone: %s\n", clone->buffer);
+	_print_counter("Live strings");
+
+	string_free_with(&COUNTING, string);
+	string_free_with(&COUNTING, clone);
+	string_builder_free(builder);
+	_print_counter("Freed strings");
+}
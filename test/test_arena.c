@@ -0,0 +1,98 @@
+#include <normalc/memory/arena.h>
+#include <normalc/collections/vector.h>
+#include <normalc/string/string.h>
+#include <stdio.h>
+#include <time.h>
+
+void test_mark();
+void test_vector();
+void test_timing();
+
+int main() {
+	test_mark();
+	test_vector();
+	test_timing();
+	return 0;
+}
+
+void test_mark() {
+	printf("\n--TEST ARENA MARK--\n\n");
+
+	Arena* arena = arena_new(64);
+	String* kept = string_from_arena(arena, "Kept across reset");
+
+	ArenaMark mark = arena_mark(arena);
+
+	// spill into several new blocks past the mark
+	for (size_t i = 0; i < 100; i++) {
+		string_from_arena(arena, "Released on reset to mark");
+	}
+
+	arena_reset_to(arena, mark);
+	string_println(kept);
+	printf("Rolled back to first block: %i\n", arena->current->previous == NULL);
+
+	arena_reset(arena);
+	printf("Used after reset: %zu\n", arena->current->used);
+
+	arena_free(arena);
+}
+
+void test_vector() {
+	printf("\n--TEST ARENA VECTOR--\n\n");
+
+	Arena* arena = arena_new(1024);
+	Vector* vector = vector_new_in(1, duplicator_empty, destructor_empty, arena);
+
+	for (size_t i = 0; i < 100; i++) {
+		char buffer[32];
+		snprintf(buffer, sizeof(buffer), "Arena element %zu", i);
+		vector_add(vector, string_from_arena(arena, buffer));
+	}
+
+	string_println(vector_get(vector, 0));
+	string_println(vector_get(vector, 99));
+
+	Vector* clone = vector_clone(vector);
+	printf("Clone count: %zu\n", clone->count);
+
+	vector_free(clone);
+	vector_free(vector);
+	arena_free(arena);
+}
+
+void test_timing() {
+	printf("\n--TEST ARENA TIMING--\n\n");
+
+	size_t count = 100000;
+	size_t rounds = 20;
+	double heap_elapsed = 0.0;
+	double arena_elapsed = 0.0;
+
+	for (size_t round = 0; round < rounds; round++) {
+		clock_t start = clock();
+		Vector* heap = vector_new(count, (Duplicator) string_clone, (Destructor) string_free);
+		for (size_t i = 0; i < count; i++) {
+			vector_add(heap, string_from("request scoped string"));
+		}
+		vector_free(heap);
+		heap_elapsed += ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	}
+
+	Arena* arena = arena_new(1 << 20);
+
+	for (size_t round = 0; round < rounds; round++) {
+		clock_t start = clock();
+		Vector* scoped = vector_new_in(count, duplicator_empty, destructor_empty, arena);
+		for (size_t i = 0; i < count; i++) {
+			vector_add(scoped, string_from_arena(arena, "request scoped string"));
+		}
+		arena_reset(arena);
+		arena_elapsed += ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	}
+
+	arena_free(arena);
+
+	printf("Heap strings (%zu x %zu): %fs\n", rounds, count, heap_elapsed);
+	printf("Arena strings (%zu x %zu): %fs\n", rounds, count, arena_elapsed);
+}
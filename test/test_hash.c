@@ -0,0 +1,179 @@
+#include <normalc/hash/hash.h>
+#include <normalc/string/string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+void test_properties();
+void test_distribution();
+void test_throughput();
+
+int main() {
+	test_properties();
+	test_distribution();
+	test_throughput();
+	return 0;
+}
+
+// The shift and add hash string_hash used before, kept to compare against
+size_t _shift_add_hash(const char* src, size_t length) {
+	size_t hash = 5381;
+
+	for (size_t i = 0; i < length; i++) {
+		hash = (hash << 5) + src[i];
+	}
+
+	return hash;
+}
+
+size_t _wyhash(const char* src, size_t length) {
+	return (size_t) hash_bytes(src, length, 0);
+}
+
+double _seconds_since(struct timespec* start) {
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+void test_properties() {
+	printf("\n--TEST HASH PROPERTIES--\n\n");
+
+	char bytes[128];
+
+	for (size_t i = 0; i < sizeof(bytes); i++) {
+		bytes[i] = (char) (i * 37 + 11);
+	}
+
+	String* string = string_from("normalc");
+	printf("Deterministic: %i\n", hash_bytes(bytes, 100, 7) == hash_bytes(bytes, 100, 7));
+	printf("Seed changes hash: %i\n", hash_bytes(bytes, 100, 7) != hash_bytes(bytes, 100, 8));
+	printf("Length changes hash: %i\n", hash_bytes(bytes, 0, 0) != hash_bytes(bytes, 1, 0));
+	printf("string_hash matches string_hash_cstring: %i\n", string_hash(string) == string_hash_cstring("normalc", 7));
+	string_free(string);
+
+	// flipping any one input bit should flip half of the output bits at every length
+	size_t flips = 0;
+	size_t trials = 0;
+	size_t low_flips = 0;
+
+	for (size_t length = 1; length <= sizeof(bytes); length++) {
+		uint64_t base = hash_bytes(bytes, length, 0);
+
+		for (size_t bit = 0; bit < length * 8; bit++) {
+			bytes[bit / 8] ^= (char) (1 << (bit % 8));
+			uint64_t flipped = hash_bytes(bytes, length, 0) ^ base;
+			bytes[bit / 8] ^= (char) (1 << (bit % 8));
+
+			flips += __builtin_popcountll(flipped);
+			low_flips += __builtin_popcountll(flipped & 0xffff);
+			trials++;
+		}
+	}
+
+	printf("Average output bits flipped per input bit: %.2f of 64 over %zu flips\n", (double) flips / trials, trials);
+	printf("Average of the low 16 bits flipped: %.2f of 16\n", (double) low_flips / trials);
+}
+
+void _print_buckets(const char* name, size_t (*hasher)(const char*, size_t), char (*keys)[64], size_t* lengths, size_t count) {
+	size_t buckets = count;
+	size_t* sizes = calloc(buckets, sizeof(size_t));
+	size_t histogram[6] = { 0 };
+	size_t longest = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		sizes[hasher(keys[i], lengths[i]) & (buckets - 1)]++;
+	}
+
+	for (size_t i = 0; i < buckets; i++) {
+		histogram[sizes[i] < 5 ? sizes[i] : 5]++;
+		longest = sizes[i] > longest ? sizes[i] : longest;
+	}
+
+	printf("%-10s empty %5.1f%%, 1: %5.1f%%, 2: %5.1f%%, 3: %5.1f%%, 4: %5.1f%%, 5+: %5.1f%%, longest %zu\n",
+			name,
+			100.0 * histogram[0] / buckets, 100.0 * histogram[1] / buckets, 100.0 * histogram[2] / buckets,
+			100.0 * histogram[3] / buckets, 100.0 * histogram[4] / buckets, 100.0 * histogram[5] / buckets,
+			longest);
+
+	free(sizes);
+}
+
+void test_distribution() {
+	printf("\n--TEST HASH BUCKET DISTRIBUTION--\n\n");
+
+	// one key per bucket on average, indexed by the low bits of the hash
+	size_t count = 1 << 16;
+	char (*keys)[64] = malloc(count * sizeof(*keys));
+	size_t* lengths = malloc(count * sizeof(size_t));
+
+	const char* formats[] = { "key_%zu", "/usr/lib/x86_64-linux-gnu/%zu.so", "%zu" };
+
+	for (size_t format = 0; format < sizeof(formats) / sizeof(formats[0]); format++) {
+		for (size_t i = 0; i < count; i++) {
+			lengths[i] = snprintf(keys[i], sizeof(*keys), formats[format], i);
+		}
+
+		printf("%zu keys like \"%s\" (ideal: empty 36.8%%, longest about 8)\n", count, keys[count - 1]);
+		_print_buckets("shift-add", _shift_add_hash, keys, lengths, count);
+		_print_buckets("wyhash", _wyhash, keys, lengths, count);
+	}
+
+	free(keys);
+	free(lengths);
+}
+
+void test_throughput() {
+	printf("\n--TEST HASH THROUGHPUT--\n\n");
+
+	size_t length = 64 << 20;
+	char* buffer = malloc(length);
+
+	for (size_t i = 0; i < length; i++) {
+		buffer[i] = (char) (i * 131 + (i >> 9));
+	}
+
+	struct timespec start;
+	size_t sink = 0;
+	size_t rounds = 4;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t round = 0; round < rounds; round++) {
+		sink += _shift_add_hash(buffer, length);
+	}
+	double shift_add = _seconds_since(&start);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t round = 0; round < rounds; round++) {
+		sink += _wyhash(buffer, length);
+	}
+	double wyhash = _seconds_since(&start);
+
+	double gigabytes = (double) (length * rounds) / 1e9;
+	printf("64 MiB buffer: shift-add %.2f GB/s, wyhash %.2f GB/s\n", gigabytes / shift_add, gigabytes / wyhash);
+
+	// short keys are what maps mostly hash, so the per call cost matters more than bandwidth
+	size_t sizes[] = { 8, 16, 32, 64 };
+	size_t calls = 20000000;
+
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (size_t i = 0; i < calls; i++) {
+			sink += _shift_add_hash(buffer + (i & 4095), sizes[s]);
+		}
+		shift_add = _seconds_since(&start);
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (size_t i = 0; i < calls; i++) {
+			sink += _wyhash(buffer + (i & 4095), sizes[s]);
+		}
+		wyhash = _seconds_since(&start);
+
+		printf("%2zu byte keys: shift-add %.1f ns, wyhash %.1f ns per hash\n",
+				sizes[s], shift_add * 1e9 / calls, wyhash * 1e9 / calls);
+	}
+
+	printf("(checksum %zu)\n", sink & 0xff);
+	free(buffer);
+}
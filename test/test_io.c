@@ -1,14 +1,28 @@
 #include <normalc/path/io.h>
+#include <normalc/memory/memory.h>
 #include <normalc/string/string.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
 
 void test_file_lines();
 void test_file_all();
 void test_input();
+void test_file_map();
+void test_line_reader();
+void test_pipe_lines();
+void test_line_index();
 
 int main() {
 	test_file_lines();
 	test_file_all();
+	test_file_map();
+	test_line_reader();
+	test_pipe_lines();
+	test_line_index();
 	test_input();
 }
 
@@ -55,3 +69,311 @@ void test_file_all() {
 	path_free(cwd);
 	path_free(test);
 }
+
+Path* _write_temp(char* name, const char* contents, size_t length) {
+	Path* path = path_from_cstring(name);
+	FILE* file = fopen(path->url->buffer, "wb");
+	fwrite(contents, 1, length, file);
+	fclose(file);
+
+	return path;
+}
+
+double _seconds_since(struct timespec* start) {
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+void test_file_map() {
+	printf("\n--Reading Mapped Files--\n\n");
+
+	// no trailing newline, and bytes a char based reader mistakes for the end of a line or file
+	char contents[] = "first\nsec\0ond\n\xff third";
+	size_t length = sizeof(contents) - 1;
+	Path* path = _write_temp("/tmp/normalc_io_map.txt", contents, length);
+
+	String* read = io_file_read(path);
+	StringView mapped;
+	bool is_mapped = io_file_map(path, &mapped);
+
+	printf("Read matches file: %i\n", read->length == length && memcmp(read->buffer, contents, length) == 0);
+	printf("Mapped matches file: %i\n", is_mapped && mapped.length == length && memcmp(mapped.buffer, contents, length) == 0);
+
+	io_file_unmap(mapped);
+	string_free(read);
+	remove(path->url->buffer);
+	path_free(path);
+
+	Path* empty = _write_temp("/tmp/normalc_io_empty.txt", "", 0);
+	read = io_file_read(empty);
+	is_mapped = io_file_map(empty, &mapped);
+	printf("Empty file: read %zu bytes, mapped %i with %zu bytes\n", read->length, is_mapped, mapped.length);
+	io_file_unmap(mapped);
+	string_free(read);
+	remove(empty->url->buffer);
+	path_free(empty);
+
+	Path* missing = path_from_cstring("/tmp/normalc_io_missing.txt");
+	read = io_file_read(missing);
+	printf("Missing file: read %zu bytes, mapped %i\n", read->length, io_file_map(missing, &mapped));
+	string_free(read);
+	path_free(missing);
+
+	// files that report no size are read until they end
+	Path* status = path_from_cstring("/proc/self/status");
+	read = io_file_read(status);
+	printf("Sizeless file read: %i\n", read->length > 0 && strncmp(read->buffer, "Name:", 5) == 0);
+	string_free(read);
+	path_free(status);
+
+	size_t large = 256 << 20;
+	char* buffer = malloc(large);
+
+	for (size_t i = 0; i < large; i++) {
+		buffer[i] = i % 64 == 63 ? '\n' : (char) ('a' + i % 26);
+	}
+
+	Path* big = _write_temp("/tmp/normalc_io_large.txt", buffer, large);
+	free(buffer);
+
+	clock_t start = clock();
+	read = io_file_read(big);
+	double read_time = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	start = clock();
+	io_file_map(big, &mapped);
+	size_t newlines = 0;
+
+	for (const char* found = mapped.buffer; (found = memchr(found, '\n', mapped.buffer + mapped.length - found)); found++) {
+		newlines++;
+	}
+
+	double map_time = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	printf("256 MiB file: read %fs (%zu bytes), map and count lines %fs (%zu lines)\n", read_time, read->length, map_time, newlines);
+
+	io_file_unmap(mapped);
+	string_free(read);
+	remove(big->url->buffer);
+	path_free(big);
+}
+
+void test_line_reader() {
+	printf("\n--Reading Lines Through A Buffer--\n\n");
+
+	char contents[] = "alpha\n\nbe\0ta\n\xff\xfe gamma\na much longer line than the smallest buffers\nlast";
+	size_t length = sizeof(contents) - 1;
+	Path* path = _write_temp("/tmp/normalc_io_lines.txt", contents, length);
+
+	// every capacity splits the lines at different refill boundaries
+	size_t failures = 0;
+
+	for (size_t capacity = 1; capacity <= 64; capacity++) {
+		FILE* file = fopen(path->url->buffer, "rb");
+		IoLineReader* reader = io_line_reader_new(file, capacity);
+		const char* expected = contents;
+		StringView line;
+		size_t lines = 0;
+
+		while (io_line_reader_next(reader, &line)) {
+			const char* stop = memchr(expected, '\n', contents + length - expected);
+			size_t expected_length = stop != NULL ? (size_t) (stop - expected) : (size_t) (contents + length - expected);
+
+			failures += line.length != expected_length || memcmp(line.buffer, expected, expected_length) != 0;
+			expected += expected_length + 1;
+			lines++;
+		}
+
+		failures += lines != 6;
+		io_line_reader_free(reader);
+		fclose(file);
+	}
+
+	printf("Line mismatches over 64 buffer sizes: %zu\n", failures);
+
+	FILE* file = fopen(path->url->buffer, "rb");
+	String* line;
+	size_t lines = 0;
+	bool kept_bytes = false;
+
+	while (io_file_read_line(&line, file)) {
+		kept_bytes |= line->length == 5 && line->buffer[2] == '\0';
+		lines++;
+		string_free(line);
+	}
+
+	string_free(line);
+	fclose(file);
+	printf("io_file_read_line: %zu lines (expected 6), keeps embedded bytes: %i\n", lines, kept_bytes);
+
+	remove(path->url->buffer);
+	path_free(path);
+
+	// a large file through the reader against a string per line
+	size_t count = 10000000;
+	FILE* large = fopen("/tmp/normalc_io_many.txt", "wb");
+
+	for (size_t i = 0; i < count; i++) {
+		fprintf(large, "%zu,entry\n", i);
+	}
+
+	fclose(large);
+
+	Path* many = path_from_cstring("/tmp/normalc_io_many.txt");
+	clock_t start = clock();
+	IoLineReader* reader = io_line_reader_open(many);
+	StringView view;
+	size_t total = 0;
+
+	for (lines = 0; io_line_reader_next(reader, &view); lines++) {
+		total += view.length;
+	}
+
+	size_t capacity = reader->capacity;
+	io_line_reader_free(reader);
+	double reader_time = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	start = clock();
+	large = fopen(many->url->buffer, "rb");
+	size_t string_lines = 0;
+
+	while (io_file_read_line(&line, large)) {
+		string_lines++;
+		string_free(line);
+	}
+
+	string_free(line);
+	fclose(large);
+	double string_time = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	printf("%zu lines: reader %fs with a %zu byte buffer (%zu bytes), strings %fs (%zu lines)\n",
+			lines, reader_time, capacity, total, string_time, string_lines);
+
+	remove(many->url->buffer);
+	path_free(many);
+}
+
+void test_pipe_lines() {
+	printf("\n--Reading Lines From A Pipe--\n\n");
+
+	// like (echo first; sleep 1; echo second) | reader, the first line must come before the writer is done
+	int ends[2];
+
+	if (pipe(ends) != 0) {
+		printf("Could not create a pipe\n");
+		return;
+	}
+
+	pid_t writer = fork();
+
+	if (writer == 0) {
+		close(ends[0]);
+		write(ends[1], "first\n", 6);
+		sleep(1);
+		write(ends[1], "second\n", 7);
+		close(ends[1]);
+		_exit(0);
+	}
+
+	close(ends[1]);
+	FILE* file = fdopen(ends[0], "rb");
+	IoLineReader* reader = io_line_reader_new(file, 0);
+	StringView line;
+	struct timespec start;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	bool first = io_line_reader_next(reader, &line) && line.length == 5 && memcmp(line.buffer, "first", 5) == 0;
+	double first_time = _seconds_since(&start);
+	bool second = io_line_reader_next(reader, &line) && line.length == 6 && memcmp(line.buffer, "second", 6) == 0;
+	bool done = !io_line_reader_next(reader, &line);
+
+	io_line_reader_free(reader);
+	fclose(file);
+	waitpid(writer, NULL, 0);
+
+	printf("First line %i before the writer finished: %i, second line %i, then end: %i\n",
+			first, first_time < 0.5, second, done);
+}
+
+void test_line_index() {
+	printf("\n--Reading Lines Through An Index--\n\n");
+
+	// the same lines as the reader sees, with and without a trailing newline and for an empty file
+	const char* cases[] = { "first\n\nthird\r\n last", "one\ntwo\n", "\n", "no newline", "" };
+	size_t expected_counts[] = { 4, 2, 1, 1, 0 };
+	size_t failures = 0;
+
+	for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+		Path* path = _write_temp("/tmp/normalc_io_index.txt", cases[c], strlen(cases[c]));
+		LineIndex* index = io_file_index_lines(path);
+		IoLineReader* reader = io_line_reader_open(path);
+		StringView line;
+		size_t i = 0;
+
+		while (io_line_reader_next(reader, &line)) {
+			StringView indexed = i < index->count ? line_index_get(index, i) : string_view_new("", 0);
+			failures += indexed.length != line.length || memcmp(indexed.buffer, line.buffer, line.length) != 0;
+			i++;
+		}
+
+		Vector* lines = io_file_read_lines(path);
+		Vector* first = io_file_read_n_lines(path, 1);
+		failures += i != index->count || index->count != expected_counts[c] || lines->count != index->count;
+		failures += first->count != (index->count > 0 ? 1u : 0u);
+
+		io_line_reader_free(reader);
+		line_index_free(index);
+		vector_free(lines);
+		vector_free(first);
+		remove(path->url->buffer);
+		path_free(path);
+	}
+
+	printf("Mismatches against the line reader: %zu\n", failures);
+
+	size_t count = 10000000;
+	FILE* large = fopen("/tmp/normalc_io_index_many.txt", "wb");
+
+	for (size_t i = 0; i < count; i++) {
+		fprintf(large, "%zu,entry\n", i);
+	}
+
+	fclose(large);
+
+	Path* many = path_from_cstring("/tmp/normalc_io_index_many.txt");
+	MemoryStats before = normalc_memory_stats();
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	LineIndex* index = io_file_index_lines(many);
+	size_t total = 0;
+
+	for (size_t i = 0; i < index->count; i++) {
+		total += line_index_get(index, i).length;
+	}
+
+	double index_time = _seconds_since(&start);
+	MemoryStats after = normalc_memory_stats();
+	size_t index_count = index->count;
+	line_index_free(index);
+
+	MemoryStats vector_before = normalc_memory_stats();
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	Vector* lines = io_file_read_lines(many);
+	double vector_time = _seconds_since(&start);
+	MemoryStats vector_after = normalc_memory_stats();
+	size_t vector_count = lines->count;
+	vector_free(lines);
+
+	printf("%zu lines (%zu bytes): index %fs, vector of strings %fs (%zu lines)\n",
+			index_count, total, index_time, vector_time, vector_count);
+
+	if (after.enabled) {
+		printf("Allocations: index %zu, vector of strings %zu\n",
+				after.total.allocations - before.total.allocations,
+				vector_after.total.allocations - vector_before.total.allocations);
+	}
+
+	remove(many->url->buffer);
+	path_free(many);
+}
@@ -0,0 +1,202 @@
+#include <normalc/path/io_batch.h>
+#include <normalc/path/io.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+void test_backends();
+void test_reuse();
+void test_directory();
+
+int main() {
+	test_backends();
+	test_reuse();
+	test_directory();
+	return 0;
+}
+
+const char* BACKEND_NAMES[] = { "auto", "io_uring", "threads" };
+
+double _seconds_since(struct timespec* start) {
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+void _write_file(const char* name, const char* contents, size_t length) {
+	FILE* file = fopen(name, "wb");
+	fwrite(contents, 1, length, file);
+	fclose(file);
+}
+
+void test_backends() {
+	printf("\n--TEST BATCH BACKENDS--\n\n");
+
+	// a file larger than the depth of any pipe or page, read whole and cut short
+	size_t large_length = 3 << 20;
+	char* large = malloc(large_length);
+
+	for (size_t i = 0; i < large_length; i++) {
+		large[i] = (char) (i * 31 + (i >> 12));
+	}
+
+	_write_file("/tmp/normalc_batch_small.txt", "hello batch", 11);
+	_write_file("/tmp/normalc_batch_empty.txt", "", 0);
+	_write_file("/tmp/normalc_batch_large.txt", large, large_length);
+
+	Path* small = path_from_cstring("/tmp/normalc_batch_small.txt");
+	Path* empty = path_from_cstring("/tmp/normalc_batch_empty.txt");
+	Path* big = path_from_cstring("/tmp/normalc_batch_large.txt");
+	Path* missing = path_from_cstring("/tmp/normalc_batch_missing.txt");
+
+	IoBatchBackend backends[] = { IO_BATCH_AUTO, IO_BATCH_URING, IO_BATCH_THREADS };
+
+	for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+		// a depth of 2 keeps files waiting for a free slot
+		IoBatch* batch = io_batch_new(2, backends[b]);
+		char small_buffer[64];
+		char cut_buffer[5];
+		char empty_buffer[8];
+		char* large_buffer = malloc(large_length + 1);
+
+		IoBatchRead reads[] = {
+			{ small, small_buffer, sizeof(small_buffer), 0, 0 },
+			{ missing, small_buffer, sizeof(small_buffer), 0, 0 },
+			{ small, cut_buffer, sizeof(cut_buffer), 0, 0 },
+			{ empty, empty_buffer, sizeof(empty_buffer), 0, 0 },
+			{ big, large_buffer, large_length + 1, 0, 0 },
+			{ small, NULL, 0, 0, 0 },
+		};
+
+		size_t succeeded = io_batch_read(batch, reads, sizeof(reads) / sizeof(reads[0]));
+
+		printf("%-8s uses %-8s: %zu of 6 succeeded, small %i, missing is ENOENT %i, cut %i, empty %i, large %i, zero capacity %i\n",
+				BACKEND_NAMES[backends[b]], BACKEND_NAMES[batch->backend], succeeded,
+				reads[0].length == 11 && memcmp(small_buffer, "hello batch", 11) == 0,
+				reads[1].error == ENOENT,
+				reads[2].length == 5 && memcmp(cut_buffer, "hello", 5) == 0,
+				reads[3].length == 0 && reads[3].error == 0,
+				reads[4].length == large_length && memcmp(large_buffer, large, large_length) == 0,
+				reads[5].length == 0 && reads[5].error == 0);
+
+		free(large_buffer);
+		io_batch_free(batch);
+	}
+
+	remove(small->url->buffer);
+	remove(empty->url->buffer);
+	remove(big->url->buffer);
+	path_free(small);
+	path_free(empty);
+	path_free(big);
+	path_free(missing);
+	free(large);
+}
+
+void test_reuse() {
+	printf("\n--TEST BATCH REUSE--\n\n");
+
+	_write_file("/tmp/normalc_batch_reuse.txt", "reused", 6);
+	Path* path = path_from_cstring("/tmp/normalc_batch_reuse.txt");
+
+	// the worker threads start with the batch, so many small reads cost no thread creation
+	IoBatch* batch = io_batch_new(0, IO_BATCH_THREADS);
+	size_t calls = 20000;
+	size_t failures = 0;
+	struct timespec start;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (size_t i = 0; i < calls; i++) {
+		char first[8];
+		char second[8];
+		IoBatchRead reads[] = {
+			{ path, first, sizeof(first), 0, 0 },
+			{ path, second, sizeof(second), 0, 0 },
+		};
+
+		failures += io_batch_read(batch, reads, 2) != 2 || reads[0].length != 6 || memcmp(second, "reused", 6) != 0;
+	}
+
+	double elapsed = _seconds_since(&start);
+	io_batch_free(batch);
+
+	printf("%zu reads of 2 files through one threads batch: %fs, failures %zu\n", calls, elapsed, failures);
+
+	remove(path->url->buffer);
+	path_free(path);
+}
+
+void test_directory() {
+	printf("\n--TEST BATCH DIRECTORY OF SMALL FILES--\n\n");
+
+	size_t count = 100000;
+	size_t file_size = 200;
+	char name[128];
+	char contents[256];
+
+	mkdir("/tmp/normalc_batch_dir", 0755);
+
+	for (size_t i = 0; i < count; i++) {
+		snprintf(name, sizeof(name), "/tmp/normalc_batch_dir/%zu.txt", i);
+		memset(contents, 'a' + (int) (i % 26), file_size);
+		_write_file(name, contents, file_size);
+	}
+
+	Path* directory = path_from_cstring("/tmp/normalc_batch_dir/");
+	Vector* files = path_get_files(directory, true);
+	IoBatchRead* reads = malloc(files->count * sizeof(IoBatchRead));
+	char* buffers = malloc(files->count * 256);
+
+	for (size_t i = 0; i < files->count; i++) {
+		reads[i] = (IoBatchRead) { vector_get(files, i), buffers + i * 256, 256, 0, 0 };
+	}
+
+	struct timespec start;
+	size_t bytes = 0;
+
+	// what callers did before: one blocking open, read and close after another
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = 0; i < files->count; i++) {
+		String* read = io_file_read(vector_get(files, i));
+		bytes += read->length;
+		string_free(read);
+	}
+	double sequential = _seconds_since(&start);
+
+	printf("%zu files of %zu bytes, page cache warm: io_file_read one by one %fs (%zu bytes)\n",
+			files->count, file_size, sequential, bytes);
+
+	IoBatchBackend backends[] = { IO_BATCH_URING, IO_BATCH_THREADS };
+
+	for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+		IoBatch* batch = io_batch_new(0, backends[b]);
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		size_t succeeded = io_batch_read(batch, reads, files->count);
+		double elapsed = _seconds_since(&start);
+
+		bytes = 0;
+		for (size_t i = 0; i < files->count; i++) {
+			bytes += reads[i].length;
+		}
+
+		printf("%-8s depth %zu: %fs, %zu succeeded (%zu bytes)\n",
+				BACKEND_NAMES[batch->backend], batch->depth, elapsed, succeeded, bytes);
+
+		io_batch_free(batch);
+	}
+
+	for (size_t i = 0; i < files->count; i++) {
+		remove(((Path*) vector_get(files, i))->url->buffer);
+	}
+
+	remove(directory->url->buffer);
+	free(reads);
+	free(buffers);
+	vector_free(files);
+	path_free(directory);
+}
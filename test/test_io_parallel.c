@@ -0,0 +1,271 @@
+#include <normalc/path/io_parallel.h>
+#include <normalc/path/io.h>
+#include <normalc/string/string_number.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+void test_chunks();
+void test_lines();
+void test_long_line();
+void test_throughput();
+
+int main() {
+	test_chunks();
+	test_lines();
+	test_long_line();
+	test_throughput();
+	return 0;
+}
+
+typedef struct {
+	size_t lines;
+	size_t bytes;
+	size_t checksum;
+	size_t bad_chunks;
+	size_t initialized;
+} Tally;
+
+double _seconds_since(struct timespec* start) {
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+void _tally_init(void* local, void* context) {
+	(void) context;
+	((Tally*) local)->initialized = 1;
+}
+
+void _tally_merge(void* result, void* local, void* context) {
+	(void) context;
+	Tally* into = result;
+	Tally* from = local;
+
+	into->lines += from->lines;
+	into->bytes += from->bytes;
+	into->checksum += from->checksum;
+	into->bad_chunks += from->bad_chunks;
+	into->initialized += from->initialized;
+}
+
+void _tally_line(StringView line, void* local, void* context) {
+	(void) context;
+	Tally* tally = local;
+
+	tally->lines++;
+	tally->bytes += line.length;
+	tally->checksum += line.length > 0 ? (size_t) line.buffer[0] * line.length : 7;
+	tally->bad_chunks += memchr(line.buffer, '\n', line.length) != NULL;
+}
+
+// chunks must hold whole lines, so only the end of the input may lack a newline
+void _tally_chunk(StringView chunk, void* local, void* context) {
+	StringView* input = context;
+	Tally* tally = local;
+
+	tally->bytes += chunk.length;
+	tally->bad_chunks += chunk.buffer[chunk.length - 1] != '\n' && chunk.buffer + chunk.length != input->buffer + input->length;
+	tally->bad_chunks += chunk.buffer != input->buffer && chunk.buffer[-1] != '\n';
+}
+
+void test_chunks() {
+	printf("\n--TEST PARALLEL CHUNKS--\n\n");
+
+	const char* inputs[] = { "a\nbb\n\nccc\ndddd dddd dddd\ne", "one line", "\n\n\n", "ends\n", "" };
+	size_t failures = 0;
+
+	for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+		StringView input = string_view_from(inputs[i]);
+
+		for (size_t chunk_size = 1; chunk_size <= 32; chunk_size++) {
+			for (size_t threads = 1; threads <= 4; threads++) {
+				Tally total = { 0 };
+				IoParallel options = { threads, chunk_size, sizeof(Tally), _tally_init, _tally_merge, &input };
+				size_t used = io_view_process_chunks(input, &options, _tally_chunk, &total);
+
+				failures += total.bytes != input.length || total.bad_chunks != 0 || total.initialized != used;
+			}
+		}
+	}
+
+	printf("Chunking failures over 5 inputs, 32 chunk sizes and 1 to 4 threads: %zu\n", failures);
+}
+
+void test_lines() {
+	printf("\n--TEST PARALLEL LINES--\n\n");
+
+	// lines of every length from 0 to 99, some longer than the chunks
+	size_t length = 0;
+	char* buffer = malloc(100 * 100);
+	Tally expected = { 0 };
+
+	for (size_t line = 0; line < 100; line++) {
+		size_t line_length = (line * 37) % 100;
+
+		for (size_t i = 0; i < line_length; i++) {
+			buffer[length++] = (char) ('a' + (line + i) % 26);
+		}
+
+		expected.lines++;
+		expected.bytes += line_length;
+		expected.checksum += line_length > 0 ? (size_t) buffer[length - line_length] * line_length : 7;
+
+		// the last line has no newline
+		if (line < 99) {
+			buffer[length++] = '\n';
+		}
+	}
+
+	StringView input = string_view_new(buffer, length);
+	size_t failures = 0;
+	size_t chunk_sizes[] = { 1, 7, 64, 100, 1000, 1 << 20 };
+
+	for (size_t c = 0; c < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); c++) {
+		for (size_t threads = 0; threads <= 8; threads++) {
+			Tally total = { 0 };
+			IoParallel options = { threads, chunk_sizes[c], sizeof(Tally), NULL, _tally_merge, NULL };
+			io_view_process_lines(input, &options, _tally_line, &total);
+
+			failures += total.lines != expected.lines || total.bytes != expected.bytes || total.checksum != expected.checksum || total.bad_chunks != 0;
+		}
+	}
+
+	printf("Line failures over 6 chunk sizes and 0 to 8 threads: %zu\n", failures);
+
+	FILE* file = fopen("/tmp/normalc_parallel_lines.txt", "wb");
+	fwrite(buffer, 1, length, file);
+	fclose(file);
+
+	Path* path = path_from_cstring("/tmp/normalc_parallel_lines.txt");
+	Path* missing = path_from_cstring("/tmp/normalc_parallel_missing.txt");
+	Tally total = { 0 };
+	IoParallel options = { 0, 64, sizeof(Tally), NULL, _tally_merge, NULL };
+	bool processed = io_file_process_lines(path, &options, _tally_line, &total);
+
+	printf("File: processed %i, %zu lines (expected %zu), same checksum %i, missing file processed %i\n",
+			processed, total.lines, expected.lines, total.checksum == expected.checksum,
+			io_file_process_lines(missing, &options, _tally_line, &total));
+
+	remove(path->url->buffer);
+	path_free(path);
+	path_free(missing);
+	free(buffer);
+}
+
+void test_long_line() {
+	printf("\n--TEST PARALLEL LONG LINE--\n\n");
+
+	// one 64 MiB line among short ones covers 16384 chunks of 4 KiB, and only the chunk holding
+	// its start may scan it, or the chunks it covers would scan 128 GiB between them
+	size_t long_length = 64 << 20;
+	size_t length = 0;
+	char* buffer = malloc(long_length + 64);
+
+	length += sprintf(buffer, "first\n");
+	memset(buffer + length, 'x', long_length);
+	length += long_length;
+	length += sprintf(buffer + length, "\nlast\nend");
+
+	StringView input = string_view_new(buffer, length);
+	size_t failures = 0;
+	double slowest = 0;
+
+	for (size_t threads = 1; threads <= 4; threads++) {
+		Tally total = { 0 };
+		IoParallel options = { threads, 4096, sizeof(Tally), NULL, _tally_merge, NULL };
+		struct timespec start;
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		io_view_process_lines(input, &options, _tally_line, &total);
+		double elapsed = _seconds_since(&start);
+		slowest = elapsed > slowest ? elapsed : slowest;
+
+		failures += total.lines != 4 || total.bytes != 5 + long_length + 4 + 3 || total.bad_chunks != 0;
+	}
+
+	printf("Line failures over 1 to 4 threads: %zu\n", failures);
+	printf("Slowest pass over a 64 MiB line with 4 KiB chunks: %fs, linear: %i\n", slowest, slowest < 0.5);
+
+	free(buffer);
+}
+
+typedef struct {
+	uint64_t sum;
+	size_t errors;
+} Sum;
+
+void _sum_merge(void* result, void* local, void* context) {
+	(void) context;
+	((Sum*) result)->sum += ((Sum*) local)->sum;
+	((Sum*) result)->errors += ((Sum*) local)->errors;
+}
+
+// lines look like "id,value", and the values are summed
+void _sum_line(StringView line, void* local, void* context) {
+	(void) context;
+	Sum* sum = local;
+	const char* comma = memchr(line.buffer, ',', line.length);
+	uint64_t value;
+
+	if (comma == NULL || string_parse_u64_cstring(comma + 1, line.buffer + line.length - comma - 1, &value) != OK) {
+		sum->errors++;
+		return;
+	}
+
+	sum->sum += value;
+}
+
+void test_throughput() {
+	printf("\n--TEST PARALLEL THROUGHPUT--\n\n");
+
+	size_t count = 20000000;
+	uint64_t expected = 0;
+	FILE* file = fopen("/tmp/normalc_parallel_many.txt", "wb");
+
+	for (size_t i = 0; i < count; i++) {
+		uint64_t value = (i * 2654435761u) % 1000000;
+		expected += value;
+		fprintf(file, "%zu,%llu\n", i, (unsigned long long) value);
+	}
+
+	fclose(file);
+
+	Path* path = path_from_cstring("/tmp/normalc_parallel_many.txt");
+	struct timespec start;
+
+	// what the callers did before: a string per line, parsed on one core
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	Vector* lines = io_file_read_lines(path);
+	Sum serial = { 0 };
+
+	for (size_t i = 0; i < lines->count; i++) {
+		String* line = vector_get(lines, i);
+		_sum_line(string_view_new(line->buffer, line->length), &serial, NULL);
+	}
+
+	vector_free(lines);
+	double vector_time = _seconds_since(&start);
+
+	Sum one = { 0 };
+	IoParallel single = { 1, 0, sizeof(Sum), NULL, _sum_merge, NULL };
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	io_file_process_lines(path, &single, _sum_line, &one);
+	double single_time = _seconds_since(&start);
+
+	Sum all = { 0 };
+	IoParallel every = { 0, 0, sizeof(Sum), NULL, _sum_merge, NULL };
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	io_file_process_lines(path, &every, _sum_line, &all);
+	double parallel_time = _seconds_since(&start);
+
+	printf("Sums match: %i, parse errors %zu\n",
+			serial.sum == expected && one.sum == expected && all.sum == expected, serial.errors + one.errors + all.errors);
+	printf("%zu lines: vector of strings %fs, 1 thread %fs, %ld threads %fs\n",
+			count, vector_time, single_time, sysconf(_SC_NPROCESSORS_ONLN), parallel_time);
+
+	remove(path->url->buffer);
+	path_free(path);
+}
@@ -4,17 +4,31 @@
 #include <normalc/error/error.h>
 #include <normalc/memory/memory.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 
 void test_memory();
 void test_complex_values();
 void test_removal();
 void test_safety();
+void test_lookup();
+void test_rehash_latency();
+void test_cached_hash();
+void test_view_lookup();
+void test_upsert();
+void test_collisions();
 
 int main() {
 	test_memory();
 	test_removal();
 	test_complex_values();
 	test_safety();
+	test_lookup();
+	test_rehash_latency();
+	test_cached_hash();
+	test_view_lookup();
+	test_upsert();
+	test_collisions();
 	return 0;
 }
 
@@ -130,3 +144,385 @@ void test_memory() {
 
 	map_free(map);
 }
+
+void test_lookup() {
+	printf("\n--TEST MAP LOOKUP--\n\n");
+
+	Map* map = map_new(
+				0,
+				(Hasher) string_hash,
+				(EqualityChecker) string_equals_string,
+				(Destructor) string_free, 
+				(Destructor) string_free, 
+				(Duplicator) string_clone, 
+				(Duplicator) string_clone
+			);
+
+	size_t inserted = 100000;
+
+	clock_t start = clock();
+	for (size_t i = 0; i < inserted; i++) {
+		map_insert(map, string_from_format("Key %zu", i), string_from_format("Value %zu", i));	
+	}
+	clock_t end = clock();
+	printf("Insert timing (%zu keys): %fs\n", inserted, ((double) (end - start)) / CLOCKS_PER_SEC);
+
+	// replacing an existing key keeps the count the same
+	map_insert(map, string_from("Key 0"), string_from("Value 0 Replaced"));
+	printf("Count after replace: %zu (expected %zu)\n", map->entry_count, inserted);
+
+	for (size_t i = 0; i < inserted; i += 2) {
+		map_delete(map, string_from_format("Key %zu", i), true);
+	}
+
+	size_t found = 0;
+	start = clock();
+	for (size_t i = 0; i < inserted; i++) {
+		String* key = string_from_format("Key %zu", i);
+		String* value = map_get_value(map, key, true);
+
+		if (value != NULL) {
+			found++;
+		}
+	}
+	end = clock();
+	printf("Lookup timing (%zu keys): %fs\n", inserted, ((double) (end - start)) / CLOCKS_PER_SEC);
+
+	String* last = map_get_value(map, string_from_format("Key %zu", inserted - 1), true);
+	printf("Found %zu keys after removal (expected %zu), last value: %s\n", found, inserted / 2, last->buffer);
+
+	Map* clone = map_clone(map);
+	printf("Clone count: %zu\n", clone->entry_count);
+
+	map_free(clone);
+	map_free(map);
+}
+
+Map* _latency_map(size_t inserted, String** keys, String** values, bool incremental) {
+	Map* map = map_new(
+				0,
+				(Hasher) string_hash,
+				(EqualityChecker) string_equals_string,
+				(Destructor) string_free, 
+				(Destructor) string_free, 
+				(Duplicator) string_clone, 
+				(Duplicator) string_clone
+			);
+
+	map_set_incremental_rehash(map, incremental);
+
+	for (size_t i = 0; i < inserted; i++) {
+		keys[i] = string_from_format("Key %zu", i);
+		values[i] = string_from_format("Value %zu", i);
+	}
+
+	return map;
+}
+
+// Times every insert, keeping the fastest time seen so far for each one in "latencies"
+void _insert_latencies(Map* map, size_t inserted, String** keys, String** values, double* latencies) {
+	struct timespec start, end;
+
+	for (size_t i = 0; i < inserted; i++) {
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		map_insert(map, keys[i], values[i]);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+
+		double elapsed = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3;
+		latencies[i] = elapsed < latencies[i] ? elapsed : latencies[i];
+	}
+}
+
+// Prints the worst insert up to each power of four and returns the worst of the last window
+double _print_worst_latencies(double* latencies, size_t inserted) {
+	double worst = 0.0;
+	double window_worst = 0.0;
+	size_t window_end = 1024;
+
+	for (size_t i = 0; i < inserted; i++) {
+		worst = latencies[i] > worst ? latencies[i] : worst;
+		window_worst = latencies[i] > window_worst ? latencies[i] : window_worst;
+
+		if (i + 1 == window_end) {
+			printf("  size %8zu: worst insert %10.1fus\n", i + 1, worst);
+			window_end *= 4;
+
+			if (i + 1 < inserted) {
+				window_worst = 0.0;
+			}
+		}
+	}
+
+	return window_worst;
+}
+
+void test_rehash_latency() {
+	printf("\n--TEST MAP REHASH LATENCY--\n\n");
+
+	size_t inserted = 1 << 20;
+	size_t runs = 3;
+	String** keys = allocate(sizeof(String*) * inserted);
+	String** values = allocate(sizeof(String*) * inserted);
+	double* latencies = allocate(sizeof(double) * inserted);
+
+	for (int incremental = 0; incremental <= 1; incremental++) {
+		for (size_t i = 0; i < inserted; i++) {
+			latencies[i] = 1e12;
+		}
+
+		// a delay at a different insert in every run is noise from the system, while work done
+		// by the map repeats at the same insert, so only the fastest of several runs is kept
+		for (size_t run = 0; run < runs; run++) {
+			Map* map = _latency_map(inserted, keys, values, incremental);
+			_insert_latencies(map, inserted, keys, values, latencies);
+
+			if (run == runs - 1) {
+				String* key = string_from("Key 12345");
+				printf("%s rehash, lookup after growth: %s\n", incremental ? "Incremental" : "Full", ((String*) map_get_value(map, key, true))->buffer);
+			}
+
+			map_free(map);
+		}
+
+		double worst_last = _print_worst_latencies(latencies, inserted);
+		double worst_small = 0.0;
+
+		for (size_t i = 0; i < 16384; i++) {
+			worst_small = latencies[i] > worst_small ? latencies[i] : worst_small;
+		}
+
+		// growth doubles the table from 16K to 1M entries, which must not show up in a single insert
+		if (incremental) {
+			printf("  worst insert stays bounded as the map grows: %i (%.1fus up to 16K entries, %.1fus from 256K to 1M)\n",
+					worst_last < 4 * worst_small + 100.0, worst_small, worst_last);
+		}
+	}
+
+	deallocate(keys);
+	deallocate(values);
+	deallocate(latencies);
+}
+
+size_t comparisons = 0;
+
+bool _counting_equals(String* string, String* other) {
+	comparisons++;
+	return string_equals_string(string, other);
+}
+
+void test_cached_hash() {
+	printf("\n--TEST MAP CACHED HASH--\n\n");
+
+	Map* map = map_new(
+				0,
+				(Hasher) string_hash,
+				(EqualityChecker) _counting_equals,
+				(Destructor) string_free, 
+				(Destructor) string_free, 
+				(Duplicator) string_clone, 
+				(Duplicator) string_clone
+			);
+
+	size_t inserted = 10000;
+
+	for (size_t i = 0; i < inserted; i++) {
+		map_insert(map, string_from_format("Key %zu", i), string_from_format("Value %zu", i));	
+	}
+
+	// growth reuses cached hashes and new keys never reach the comparator
+	printf("Comparisons during insert: %zu (expected 0)\n", comparisons);
+
+	comparisons = 0;
+	for (size_t i = 0; i < inserted; i++) {
+		map_get_entry(map, string_from_format("Key %zu", i), true);
+	}
+
+	printf("Comparisons during lookup: %zu (expected %zu)\n", comparisons, inserted);
+	map_free(map);
+}
+
+void test_view_lookup() {
+	printf("\n--TEST MAP VIEW LOOKUP--\n\n");
+
+	Map* map = map_new(
+				0,
+				(Hasher) string_hash,
+				(EqualityChecker) string_equals_string,
+				(Destructor) string_free, 
+				(Destructor) string_free, 
+				(Duplicator) string_clone, 
+				(Duplicator) string_clone
+			);
+
+	for (size_t i = 0; i < 100; i++) {
+		map_insert(map, string_from_format("Key %zu", i), string_from_format("Value %zu", i));	
+	}
+
+	// lookup by a slice of a larger buffer without building a String
+	char* line = "Key 42=ignored";
+	String* value = map_get_value_view(map, line, 6, string_hash_cstring, (ViewEqualityChecker) string_equals_cstring);
+	printf("Borrowed 'Key 42': %s\n", value->buffer);
+
+	printf("Contains 'Key 7': %i\n", map_contains_view(map, "Key 7", 5, string_hash_cstring, (ViewEqualityChecker) string_equals_cstring));
+	map_delete_view(map, "Key 7", 5, string_hash_cstring, (ViewEqualityChecker) string_equals_cstring);
+	printf("Contains 'Key 7' after delete: %i\n", map_contains_view(map, "Key 7", 5, string_hash_cstring, (ViewEqualityChecker) string_equals_cstring));
+	printf("Contains 'Key 70': %i\n", map_contains(map, string_from("Key 70"), true));
+	printf("Count: %zu\n", map->entry_count);
+
+	// a claimed entry is built from the view only when the key is missing
+	bool found;
+	Entry* existing = map_claim_view(map, "Key 42", 6, string_hash_cstring, (ViewEqualityChecker) string_equals_cstring, &found);
+	printf("Claim 'Key 42': found %i, value %s\n", found, ((String*) existing->value)->buffer);
+
+	Entry* claimed = map_claim_view(map, "Key 7", 5, string_hash_cstring, (ViewEqualityChecker) string_equals_cstring, &found);
+	claimed->key = string_from("Key 7");
+	claimed->value = string_from("Claimed 7");
+	value = map_get_value(map, string_from("Key 7"), true);
+	printf("Claim 'Key 7': found %i, then looked up %s, count %zu\n", found, value->buffer, map->entry_count);
+
+	map_free(map);
+}
+
+void* _count_new(__attribute__ ((unused)) void* key) {
+	size_t* count = allocate(sizeof(size_t));
+	*count = 0;
+	return count;
+}
+
+void _count_merge(void* stored, void* given) {
+	*(size_t*) stored += *(size_t*) given;
+}
+
+void test_upsert() {
+	printf("\n--TEST MAP UPSERT--\n\n");
+
+	Map* map = map_new(
+				0,
+				(Hasher) string_hash,
+				(EqualityChecker) string_equals_string,
+				(Destructor) string_free, 
+				(Destructor) deallocate, 
+				(Duplicator) string_clone, 
+				(Duplicator) duplicator_empty
+			);
+
+	String* text = string_from("the quick brown fox jumps over the lazy dog the end");
+	Vector* words = string_split(text, ' ');
+
+	for (size_t i = 0; i < words->count; i++) {
+		size_t** count = (size_t**) map_get_or_insert(map, string_clone(vector_get(words, i)), _count_new);
+		(**count)++;
+	}
+
+	size_t* extra = allocate(sizeof(size_t));
+	*extra = 10;
+	map_upsert(map, string_from("the"), extra, _count_merge);
+
+	size_t* first = allocate(sizeof(size_t));
+	*first = 1;
+	bool inserted;
+	size_t** stored = (size_t**) map_try_insert(map, string_from("the"), first, &inserted);
+	printf("Try insert existing 'the': inserted %i, count %zu (expected 13)\n", inserted, **stored);
+
+	size_t* count_fox = map_get_value(map, string_from("fox"), true);
+	printf("Count 'fox': %zu (expected 1), distinct words: %zu (expected 9)\n", *count_fox, map->entry_count);
+
+	vector_free(words);
+	string_free(text);
+	map_free(map);
+}
+
+// Plain wyhash zeroes its state when the first 8 bytes of a 17 to 32 byte key equal one of its
+// public constants, so keys sharing that prefix and their last 16 bytes would collide for any seed
+String* _crafted_key(size_t i) {
+	unsigned char prefix[8] = { 0xc9, 0xac, 0x2e, 0x96, 0x93, 0x4b, 0xb8, 0x8b };
+	char buffer[33];
+
+	memcpy(buffer, prefix, sizeof(prefix));
+	snprintf(buffer + 8, sizeof(buffer) - 8, "%08zx-crafted-tail-00", i);
+
+	return string_from(buffer);
+}
+
+double _insert_all(Hasher hasher, String** keys, size_t count) {
+	Map* map = map_new(0, hasher, (EqualityChecker) string_equals_string,
+				destructor_empty, destructor_empty, duplicator_empty, duplicator_empty);
+
+	clock_t start = clock();
+
+	for (size_t i = 0; i < count; i++) {
+		map_insert(map, keys[i], keys[i]);
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (map_get_value(map, keys[i], false) != keys[i]) {
+			printf("Missing crafted key %zu\n", i);
+		}
+	}
+
+	double elapsed = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	map_free(map);
+
+	return elapsed;
+}
+
+void test_collisions() {
+	printf("\n--TEST MAP CRAFTED COLLISIONS--\n\n");
+
+	size_t count = 4000;
+	String** keys = malloc(count * sizeof(String*));
+	size_t fast_collisions = 0;
+	size_t keyed_collisions = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		keys[i] = _crafted_key(i);
+	}
+
+	for (size_t i = 1; i < count; i++) {
+		fast_collisions += string_hash(keys[i]) == string_hash(keys[0]);
+		keyed_collisions += string_hash_keyed(keys[i]) == string_hash_keyed(keys[0]);
+	}
+
+	printf("Keys sharing the first key's hash: string_hash %zu, string_hash_keyed %zu (of %zu)\n",
+			fast_collisions, keyed_collisions, count - 1);
+
+	double fast = _insert_all((Hasher) string_hash, keys, count);
+	double keyed = _insert_all((Hasher) string_hash_keyed, keys, count);
+	printf("Insert and find %zu crafted keys: string_hash %fs, string_hash_keyed %fs\n", count, fast, keyed);
+
+	// the same keys inserted into two maps land in different slots
+	Map* first = map_new(0, (Hasher) string_hash, (EqualityChecker) string_equals_string,
+				destructor_empty, destructor_empty, duplicator_empty, duplicator_empty);
+	Map* second = map_new(0, (Hasher) string_hash, (EqualityChecker) string_equals_string,
+				destructor_empty, destructor_empty, duplicator_empty, duplicator_empty);
+	size_t same_slot = 0;
+
+	for (size_t i = 0; i < 64; i++) {
+		String* key = string_from_format("key %zu", i);
+		map_insert(first, key, key);
+		map_insert(second, key, key);
+	}
+
+	for (size_t slot = 0; slot < first->entries->capacity; slot++) {
+		Entry* in_first = first->entries->data[slot];
+		Entry* in_second = second->entries->data[slot];
+		same_slot += in_first != NULL && in_second != NULL && in_first->key == in_second->key;
+	}
+
+	printf("Keys in the same slot of two maps: %zu of 64 (seeds differ: %i)\n", same_slot, first->seed != second->seed);
+
+	for (size_t slot = 0; slot < first->entries->capacity; slot++) {
+		if (first->entries->data[slot] != NULL) {
+			string_free(first->entries->data[slot]->key);
+		}
+	}
+
+	map_free(first);
+	map_free(second);
+
+	for (size_t i = 0; i < count; i++) {
+		string_free(keys[i]);
+	}
+
+	free(keys);
+}
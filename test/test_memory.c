@@ -0,0 +1,64 @@
+#include <normalc/memory/memory.h>
+#include <normalc/collections/map.h>
+#include <normalc/string/string.h>
+#include <normalc/path/io.h>
+#include <stdio.h>
+
+void test_subsystems();
+void test_release();
+
+int main() {
+	test_subsystems();
+	test_release();
+	return 0;
+}
+
+size_t _string_hash(String* key) {
+	return string_hash(key);
+}
+
+Map* _map_of_strings(size_t count) {
+	Map* map = map_new(
+				1,
+				(Hasher) _string_hash,
+				(EqualityChecker) string_equals_string,
+				(Destructor) string_free,
+				(Destructor) string_free,
+				(Duplicator) string_clone,
+				(Duplicator) string_clone
+			);
+
+	for (size_t i = 0; i < count; i++) {
+		map_insert(map, string_from_format("key%zu", i), string_from_format("value%zu", i));
+	}
+
+	return map;
+}
+
+void test_subsystems() {
+	printf("\n--TEST MEMORY SUBSYSTEMS--\n\n");
+
+	Map* map = _map_of_strings(1000);
+	Path* path = path_from_cstring("file.txt");
+	Vector* lines = io_file_read_lines(path);
+
+	MemoryStats stats = normalc_memory_stats();
+	memory_stats_print(&stats, stdout);
+
+	vector_free(lines);
+	path_free(path);
+	map_free(map);
+}
+
+void test_release() {
+	printf("\n--TEST MEMORY RELEASE--\n\n");
+
+	MemoryStats before = normalc_memory_stats();
+	map_free(_map_of_strings(10000));
+	MemoryStats after = normalc_memory_stats();
+
+	printf("Live bytes unchanged after free: %i\n", before.total.live_bytes == after.total.live_bytes);
+	printf("Peak grew while the map was live: %i\n", !after.enabled || after.total.peak_bytes > before.total.peak_bytes);
+	printf("Map allocations counted: %i\n",
+			!after.enabled || after.subsystems[MEMORY_MAP].allocations > before.subsystems[MEMORY_MAP].allocations);
+}
@@ -0,0 +1,141 @@
+#include <normalc/memory/pool.h>
+#include <normalc/collections/linked_list.h>
+#include <normalc/collections/map.h>
+#include <normalc/string/string.h>
+#include <stdio.h>
+#include <time.h>
+
+void test_reuse();
+void test_list_churn();
+void test_map_churn();
+
+int main() {
+	test_reuse();
+	test_list_churn();
+	test_map_churn();
+	return 0;
+}
+
+POOL_SAFE(Node, node)
+
+void test_reuse() {
+	printf("\n--TEST POOL REUSE--\n\n");
+
+	Pool* pool = pool_node_new(4);
+
+	Node* first = pool_node_take(pool);
+	pool_node_release(pool, first);
+	Node* second = pool_node_take(pool);
+
+	printf("Released object reused: %i\n", first == second);
+
+	for (size_t i = 0; i < 10; i++) {
+		pool_node_take(pool);
+	}
+
+	printf("Live objects: %zu\n", pool->count);
+	pool_free(pool);
+}
+
+size_t _size_hash(size_t* key) {
+	return *key;
+}
+
+bool _size_equals(size_t* key, size_t* other) {
+	return *key == *other;
+}
+
+double _list_churn(Pool* pool, size_t rounds, size_t length) {
+	String* element = string_from("Element");
+	clock_t start = clock();
+
+	for (size_t round = 0; round < rounds; round++) {
+		Node* head = pool ? linked_node_new_in(element, NULL, pool) : linked_node_new(element, NULL);
+		LinkedList* list = pool
+			? linked_list_new_in(head, destructor_empty, duplicator_empty, pool)
+			: linked_list_new(head, destructor_empty, duplicator_empty);
+
+		for (size_t i = 0; i < length; i++) {
+			Node* node = pool ? linked_node_new_in(element, list->head, pool) : linked_node_new(element, list->head);
+			list->head = node;
+			list->count++;
+		}
+
+		while (list->head->next != NULL) {
+			linked_list_delete_head(list);
+		}
+
+		linked_list_free(list);
+	}
+
+	string_free(element);
+	return ((double) (clock() - start)) / CLOCKS_PER_SEC;
+}
+
+void test_list_churn() {
+	printf("\n--TEST POOL LINKED LIST CHURN--\n\n");
+
+	size_t rounds = 2000;
+	size_t length = 1000;
+
+	printf("Heap nodes (%zu x %zu push/pop): %fs\n", rounds, length, _list_churn(NULL, rounds, length));
+
+	Pool* pool = pool_new(sizeof(Node), 1024);
+	printf("Pooled nodes (%zu x %zu push/pop): %fs\n", rounds, length, _list_churn(pool, rounds, length));
+	printf("Live nodes after churn: %zu\n", pool->count);
+	pool_free(pool);
+}
+
+double _map_churn(Pool* pool, size_t* keys, size_t rounds, size_t count) {
+	Map* map = map_new(
+				count,
+				(Hasher) _size_hash,
+				(EqualityChecker) _size_equals,
+				destructor_empty,
+				destructor_empty,
+				duplicator_empty,
+				duplicator_empty
+			);
+
+	if (pool != NULL) {
+		map_set_entry_pool(map, pool);
+	}
+
+	clock_t start = clock();
+
+	for (size_t round = 0; round < rounds; round++) {
+		for (size_t i = 0; i < count; i++) {
+			map_insert(map, &keys[i], &keys[i]);
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			map_delete(map, &keys[i], false);
+		}
+	}
+
+	double elapsed = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	map_free(map);
+
+	return elapsed;
+}
+
+void test_map_churn() {
+	printf("\n--TEST POOL MAP CHURN--\n\n");
+
+	size_t rounds = 200;
+	size_t count = 10000;
+	size_t* keys = allocate(sizeof(size_t) * count);
+
+	for (size_t i = 0; i < count; i++) {
+		keys[i] = i * 7919;
+	}
+
+	printf("Heap entries (%zu x %zu insert/delete): %fs\n", rounds, count, _map_churn(NULL, keys, rounds, count));
+
+	Pool* pool = pool_new(sizeof(Entry), 1024);
+	printf("Pooled entries (%zu x %zu insert/delete): %fs\n", rounds, count, _map_churn(pool, keys, rounds, count));
+	printf("Live entries after churn: %zu\n", pool->count);
+	pool_free(pool);
+
+	deallocate(keys);
+}
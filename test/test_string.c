@@ -1,18 +1,43 @@
 #include <normalc/string/string.h>
 #include <normalc/string/string_builder.h>
+#include <normalc/string/string_view.h>
+#include <normalc/string/string_pool.h>
+#include <normalc/string/string_number.h>
+#include <normalc/collections/map.h>
+#include <pthread.h>
+#include <math.h>
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 
 void test_builder();
 void test_string();
 void test_split();
 void test_substrings();
+void test_search();
+void test_scan();
+void test_views();
+void test_split_iter();
+void test_inline();
+void test_intern();
+void test_builder_growth();
+void test_builder_format();
+void test_numbers();
 
 int main() {
 	// test_string();
 	test_builder();
 	// test_split();
 	// test_substrings();
+	test_search();
+	test_scan();
+	test_views();
+	test_split_iter();
+	test_inline();
+	test_intern();
+	test_builder_growth();
+	test_builder_format();
+	test_numbers();
 	return 0;
 }
 
@@ -129,3 +154,911 @@ void test_string() {
 	string_free(hello);
 	string_free(clone);
 }
+
+// Reference used to check the search results and to time against
+int _naive_index_of(String* string, char* query, bool last) {
+	size_t length = strlen(query);
+	int found = -1;
+
+	for (size_t i = 0; length > 0 && i + length <= string->length; i++) {
+		if (memcmp(string->buffer + i, query, length) == 0) {
+			found = i;
+
+			if (!last) {
+				break;
+			}
+		}
+	}
+
+	return found;
+}
+
+void test_search() {
+	printf("\nSTRING SEARCH TESTS\n\n");
+
+	// small alphabet so partial matches are common
+	srand(7);
+	size_t mismatches = 0;
+
+	for (size_t round = 0; round < 2000; round++) {
+		char haystack[200];
+		char needle[80];
+		size_t length = rand() % sizeof(haystack);
+		size_t needle_length = 1 + rand() % (round % 2 ? 4 : sizeof(needle) - 1);
+
+		for (size_t i = 0; i < length; i++) {
+			haystack[i] = 'a' + rand() % 3;
+		}
+
+		for (size_t i = 0; i < needle_length; i++) {
+			needle[i] = 'a' + rand() % 3;
+		}
+
+		haystack[length] = '\0';
+		needle[needle_length] = '\0';
+
+		// plant the needle so long needles are found too
+		if (round % 3 == 0 && needle_length <= length) {
+			memcpy(haystack + rand() % (length - needle_length + 1), needle, needle_length);
+		}
+
+		String* string = string_from(haystack);
+		mismatches += string_index_of_string(string, needle) != _naive_index_of(string, needle, false);
+		mismatches += string_index_of_last_string(string, needle) != _naive_index_of(string, needle, true);
+		string_free(string);
+	}
+
+	printf("Search mismatches against naive scan: %zu\n", mismatches);
+
+	String* hello = string_from("Hello World! This is a message with two Hello's.");
+	String* replaced = string_replace(hello, "Hello", "Goodbye");
+	string_println(replaced);
+	string_free(replaced);
+	string_free(hello);
+
+	// 8 MiB log-like payload with the needle only at the very end
+	size_t size = 8 << 20;
+	StringBuilder* builder = string_builder_new();
+
+	while (builder->length < size) {
+		string_builder_append(builder, "2024-01-01 12:00:00 INFO request served path=/api/v1/items status=200 ");
+	}
+
+	string_builder_append(builder, "FATAL needle 0123456789abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ end");
+	String* payload = string_builder_build(builder);
+	string_builder_free(builder);
+
+	char* needle = "FATAL needle 0123456789abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ end";
+	size_t lengths[] = { 1, 2, 4, 8, 16, 32, 64, 89 };
+
+	for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+		char query[128];
+		memcpy(query, needle, lengths[i]);
+		query[lengths[i]] = '\0';
+
+		// single bytes would hit the payload early, search for one absent from it
+		if (lengths[i] == 1) {
+			query[0] = '#';
+		}
+
+		clock_t start = clock();
+		int found = string_index_of_string(payload, query);
+		double search = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+		start = clock();
+		int expected = _naive_index_of(payload, query, false);
+		double naive = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+		start = clock();
+		int found_last = string_index_of_last_string(payload, query);
+		double search_last = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+		printf("Needle %2zu bytes: search %fs (%6.2f GB/s), last %fs, naive %fs, agree %i\n",
+				lengths[i], search, payload->length / search / 1e9, search_last, naive,
+				found == expected && (lengths[i] == 1 || found_last == found));
+	}
+
+	clock_t start = clock();
+	String* replaced_payload = string_replace(payload, "status=200", "status=201");
+	printf("Replace over %zu bytes: %fs\n", payload->length, ((double) (clock() - start)) / CLOCKS_PER_SEC);
+
+	string_free(replaced_payload);
+	string_free(payload);
+}
+
+int _naive_nth_index_of(String* string, size_t n, char query, bool last) {
+	size_t count = 0;
+
+	for (size_t i = 0; i < string->length; i++) {
+		size_t index = last ? string->length - 1 - i : i;
+
+		if (string->buffer[index] == query && ++count >= n) {
+			return index;
+		}
+	}
+
+	return -1;
+}
+
+void test_scan() {
+	printf("\nSTRING SCAN TESTS\n\n");
+
+	srand(11);
+	size_t mismatches = 0;
+
+	for (size_t round = 0; round < 2000; round++) {
+		char buffer[300];
+		size_t length = rand() % sizeof(buffer);
+
+		for (size_t i = 0; i < length; i++) {
+			buffer[i] = rand() % 4 ? 'a' : '/';
+		}
+
+		buffer[length] = '\0';
+		String* string = string_from(buffer);
+		size_t n = 1 + rand() % 40;
+
+		mismatches += string_nth_index_of(string, n, '/') != _naive_nth_index_of(string, n, '/', false);
+		mismatches += string_nth_index_of_last(string, n, '/') != _naive_nth_index_of(string, n, '/', true);
+
+		// every part of the split is a non-empty run without delimiters
+		Vector* split = string_split(string, '/');
+		size_t parts_length = 0;
+
+		for (size_t i = 0; i < split->count; i++) {
+			String* part = vector_get(split, i);
+			mismatches += part->length == 0 || string_contains(part, '/');
+			parts_length += part->length;
+		}
+
+		size_t expected_length = 0;
+
+		for (size_t i = 0; i < length; i++) {
+			expected_length += buffer[i] != '/';
+		}
+
+		mismatches += parts_length != expected_length;
+		vector_free(split);
+		string_free(string);
+	}
+
+	printf("Scan mismatches against naive scan: %zu\n", mismatches);
+
+	String* single = string_from("a-bc-d");
+	Vector* parts = string_split(single, '-');
+	printf("Split of \"a-bc-d\" has %zu parts, last: %s\n", parts->count, ((String*) vector_get(parts, parts->count - 1))->buffer);
+	vector_free(parts);
+	string_free(single);
+
+	// long path-like input
+	StringBuilder* builder = string_builder_new();
+
+	while (builder->length < (8 << 20)) {
+		string_builder_append(builder, "/usr/local/share/normalc/some_longer_directory_name");
+	}
+
+	String* path = string_builder_build(builder);
+	string_builder_free(builder);
+
+	clock_t start = clock();
+	int nth = string_nth_index_of(path, 100000, '/');
+	double forward = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	start = clock();
+	int nth_last = string_nth_index_of_last(path, 100000, '/');
+	double backward = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	start = clock();
+	int naive = _naive_nth_index_of(path, 100000, '/', false);
+	double naive_time = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	printf("100000th '/' over %zu bytes: forward %fs, backward %fs, naive %fs, agree %i\n",
+			path->length, forward, backward, naive_time,
+			nth == naive && nth_last == _naive_nth_index_of(path, 100000, '/', true));
+
+	start = clock();
+	Vector* split = string_split(path, '/');
+	printf("Split into %zu parts: %fs\n", split->count, ((double) (clock() - start)) / CLOCKS_PER_SEC);
+
+	vector_free(split);
+	string_free(path);
+}
+
+void test_views() {
+	printf("\nSTRING VIEW TESTS\n\n");
+
+	String* line = string_from("  key = value  ");
+	StringView trimmed = string_view_trim(string_view_of(line));
+	int equals = string_view_index_of(trimmed, '=');
+	StringView key = string_view_trim(string_view_substring(trimmed, 0, equals));
+	StringView value = string_view_trim(string_view_substring(trimmed, equals + 1, trimmed.length - equals - 1));
+
+	printf("Trimmed: '%.*s'\n", (int) trimmed.length, trimmed.buffer);
+	printf("Key: '%.*s', value: '%.*s'\n", (int) key.length, key.buffer, (int) value.length, value.buffer);
+	printf("Key equals \"key\": %i\n", string_view_equals(key, string_view_from("key")));
+	printf("Compare key to value: %i\n", string_view_compare(key, value) < 0);
+	printf("Hash matches string_hash: %i\n", string_view_hash(key) == string_hash(&(String) { "key", 3 }));
+	printf("Find \"lue\" in value: %i\n", string_view_index_of_view(value, string_view_from("lue")));
+	string_free(line);
+
+	// 1 MiB of comma separated tokens
+	StringBuilder* builder = string_builder_new();
+
+	while (builder->length < (1 << 20)) {
+		string_builder_append(builder, "alpha,beta,,gamma,delta,");
+	}
+
+	String* csv = string_builder_build(builder);
+	string_builder_free(builder);
+
+	Array* views = array_new(16, sizeof(StringView));
+	size_t rounds = 20;
+	size_t parts = 0;
+
+	clock_t start = clock();
+
+	for (size_t i = 0; i < rounds; i++) {
+		parts = string_split_views(csv, ',', views);
+	}
+
+	double view_time = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	MemoryStats before = normalc_memory_stats();
+	string_split_views(csv, ',', views);
+	MemoryStats after = normalc_memory_stats();
+
+	start = clock();
+	Vector* split = NULL;
+
+	for (size_t i = 0; i < rounds; i++) {
+		if (split != NULL) {
+			vector_free(split);
+		}
+
+		split = string_split(csv, ',');
+	}
+
+	double split_time = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	bool same = split->count == parts;
+	for (size_t i = 0; same && i < parts; i++) {
+		same = string_view_equals(*(StringView*) array_get(views, i), string_view_of(vector_get(split, i)));
+	}
+
+	printf("Tokens in %zu bytes: %zu, views match split: %i\n", csv->length, parts, same);
+	printf("Allocations while reusing the view array: %zu\n", after.total.allocations - before.total.allocations);
+	printf("Split %zu x 1 MiB: views %fs, strings %fs\n", rounds, view_time, split_time);
+
+	vector_free(split);
+	array_free(views);
+	string_free(csv);
+}
+
+void _print_parts(StringSplitIter iter) {
+	StringView part;
+
+	while (string_split_iter_next(&iter, &part)) {
+		printf("[%.*s]", (int) part.length, part.buffer);
+	}
+
+	printf("\n");
+}
+
+void test_split_iter() {
+	printf("\nSTRING SPLIT ITERATOR TESTS\n\n");
+
+	StringView record = string_view_from("a,,b,");
+	_print_parts(string_split_iter(record, ',', false));
+	_print_parts(string_split_iter(record, ',', true));
+	_print_parts(string_split_iter(string_view_from(""), ',', true));
+	_print_parts(string_split_iter(string_view_from("x::y::::z"), ':', false));
+	_print_parts(string_split_iter_view(string_view_from("x::y::::z"), string_view_from("::"), true));
+
+	// stream over 8 MiB of records, checking the parts against the reusable array split
+	StringBuilder* builder = string_builder_new();
+
+	while (builder->length < (8 << 20)) {
+		string_builder_append(builder, "2024-01-01,GET,/api/items,200,,0.003\n");
+	}
+
+	String* log = string_builder_build(builder);
+	string_builder_free(builder);
+
+	Array* views = array_new(16, sizeof(StringView));
+	string_split_views(log, ',', views);
+
+	StringSplitIter iter = string_split_iter(string_view_of(log), ',', false);
+	StringView part;
+	size_t count = 0;
+	bool same = true;
+
+	clock_t start = clock();
+
+	while (string_split_iter_next(&iter, &part)) {
+		same = same && string_view_equals(part, *(StringView*) array_get(views, count));
+		count++;
+	}
+
+	double elapsed = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	printf("Streamed %zu parts of %zu bytes in %fs, match split: %i\n", count, log->length, elapsed, same && count == views->count);
+
+	// stop at the first error status without touching the rest
+	iter = string_split_iter_view(string_view_of(log), string_view_from(",200,"), false);
+	string_split_iter_next(&iter, &part);
+	printf("First record before status: %.*s\n", (int) part.length, part.buffer);
+
+	array_free(views);
+	string_free(log);
+}
+
+void test_inline() {
+	printf("\nSTRING INLINE STORAGE TESTS\n\n");
+
+	String* key = string_from("identifier_42");
+	printf("Buffer follows struct: %i\n", key->buffer == (char*) (key + 1));
+
+	MemoryStats before = normalc_memory_stats();
+	String* clone = string_clone(key);
+	string_free(clone);
+	MemoryStats after = normalc_memory_stats();
+
+	if (after.enabled) {
+		printf("Allocations for clone and free: %zu, %zu\n",
+				after.total.allocations - before.total.allocations, after.total.frees - before.total.frees);
+	}
+
+	string_free(key);
+
+	size_t count = 1000000;
+	Vector* keys = vector_new(count, (Duplicator) string_clone, (Destructor) string_free);
+	clock_t start = clock();
+
+	for (size_t i = 0; i < count; i++) {
+		vector_add(keys, string_from_format("key_%zu", i));
+	}
+
+	double build = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	start = clock();
+	size_t total = 0;
+
+	for (size_t i = 0; i < keys->count; i++) {
+		String* current = vector_get(keys, i);
+		total += current->length + (unsigned char) current->buffer[current->length - 1];
+	}
+
+	double scan = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	start = clock();
+	Vector* cloned = vector_clone(keys);
+	vector_free(cloned);
+	double churn = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	printf("%zu short strings: build %fs, scan %fs (%zu), clone and free %fs\n", count, build, scan, total, churn);
+	vector_free(keys);
+}
+
+typedef struct {
+	StringPool* pool;
+	StringView* views;
+	String** interned;
+	size_t count;
+} _InternJob;
+
+void* _intern_worker(void* argument) {
+	_InternJob* job = argument;
+	string_pool_intern_all(job->pool, job->views, job->count, job->interned);
+	return NULL;
+}
+
+void test_intern() {
+	printf("\n--TEST STRING INTERNING--\n\n");
+
+	StringPool* pool = string_pool_new();
+	char buffer[] = "alpha beta alpha";
+
+	String* first = string_pool_intern(pool, string_view_new(buffer, 5));
+	String* second = string_pool_intern(pool, string_view_new(buffer + 11, 5));
+	String* other = string_pool_intern_cstring(pool, "beta");
+
+	printf("Same contents share a pointer: %i\n", first == second && string_interned_equals(first, second));
+	printf("Different contents differ: %i\n", !string_interned_equals(first, other));
+	printf("Stored hash matches string_hash: %i\n", string_interned_hash(first) == string_hash(first));
+	printf("Interned contents: %s, terminated: %i\n", first->buffer, first->buffer[first->length] == '\0');
+	printf("Find interned: %i, find missing: %i\n",
+			string_pool_find(pool, string_view_from("beta")) == other,
+			string_pool_find(pool, string_view_from("gamma")) == NULL);
+	printf("Distinct strings: %zu (expected 2)\n", string_pool_count(pool));
+
+	// every thread interns the same words from its own copies, in its own order
+	size_t words = 20000;
+	size_t threads = 4;
+	char (*text)[16] = malloc(threads * words * sizeof(*text));
+	StringView* views = malloc(threads * words * sizeof(StringView));
+	String** interned = malloc(threads * words * sizeof(String*));
+	pthread_t workers[4];
+	_InternJob jobs[4];
+
+	for (size_t t = 0; t < threads; t++) {
+		for (size_t i = 0; i < words; i++) {
+			size_t word = t % 2 == 0 ? i : words - 1 - i;
+			size_t slot = t * words + i;
+			int length = snprintf(text[slot], sizeof(*text), "word_%zu", word);
+			views[slot] = string_view_new(text[slot], length);
+		}
+
+		jobs[t] = (_InternJob) { pool, views + t * words, interned + t * words, words };
+		pthread_create(&workers[t], NULL, _intern_worker, &jobs[t]);
+	}
+
+	for (size_t t = 0; t < threads; t++) {
+		pthread_join(workers[t], NULL);
+	}
+
+	size_t mismatches = 0;
+
+	for (size_t t = 1; t < threads; t++) {
+		for (size_t i = 0; i < words; i++) {
+			size_t word = t % 2 == 0 ? i : words - 1 - i;
+
+			if (interned[t * words + i] != interned[word]) {
+				mismatches++;
+			}
+		}
+	}
+
+	printf("Concurrent interning: %zu mismatches, %zu distinct (expected %zu)\n", mismatches, string_pool_count(pool), words + 2);
+
+	// lookups keyed by interned pointers against ordinary string keys
+	Map* names = map_new(
+				0,
+				(Hasher) string_hash,
+				(EqualityChecker) string_equals_string,
+				(Destructor) string_free,
+				destructor_empty,
+				(Duplicator) string_clone,
+				duplicator_empty
+			);
+	Map* symbols = string_pool_map_new(0, destructor_empty, duplicator_empty);
+	String** keys = malloc(words * sizeof(String*));
+
+	for (size_t i = 0; i < words; i++) {
+		keys[i] = string_from_view(views[i]);
+		map_insert(names, string_clone(keys[i]), interned[i]);
+		map_insert(symbols, interned[i], interned[i]);
+	}
+
+	size_t rounds = 50;
+	size_t found = 0;
+	clock_t start = clock();
+
+	for (size_t round = 0; round < rounds; round++) {
+		for (size_t i = 0; i < words; i++) {
+			found += map_get_value(names, keys[i], false) != NULL;
+		}
+	}
+
+	double by_contents = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	start = clock();
+
+	for (size_t round = 0; round < rounds; round++) {
+		for (size_t i = 0; i < words; i++) {
+			found += map_get_value(symbols, interned[i], false) == interned[i];
+		}
+	}
+
+	double by_pointer = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	printf("%zu lookups: string keys %fs, interned keys %fs (%zu found)\n", rounds * words, by_contents, by_pointer, found);
+
+	for (size_t i = 0; i < words; i++) {
+		string_free(keys[i]);
+	}
+
+	free(keys);
+	map_free(names);
+	map_free(symbols);
+	free(interned);
+	free(views);
+	free(text);
+	string_pool_free(pool);
+}
+
+size_t BUILDER_ALLOCATIONS = 0;
+size_t BUILDER_REALLOCATIONS = 0;
+
+void* _growth_allocate(__attribute__ ((unused)) void* context, size_t size) {
+	BUILDER_ALLOCATIONS++;
+	return allocate(size);
+}
+
+void* _growth_reallocate(__attribute__ ((unused)) void* context, void* pointer, __attribute__ ((unused)) size_t old_size, size_t new_size) {
+	BUILDER_REALLOCATIONS++;
+	return reallocate(pointer, new_size);
+}
+
+void _growth_free(__attribute__ ((unused)) void* context, void* pointer, __attribute__ ((unused)) size_t size) {
+	deallocate(pointer);
+}
+
+void test_builder_growth() {
+	printf("\nSTRING BUILDER GROWTH TESTS\n\n");
+
+	Allocator counting = { _growth_allocate, _growth_reallocate, _growth_free, NULL };
+	char chunk[] = "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcde\n";
+	size_t target = 100 << 20;
+	size_t appends = target / (sizeof(chunk) - 1);
+
+	StringBuilder* counted = string_builder_new_with(&counting);
+
+	for (size_t i = 0; i < appends; i++) {
+		string_builder_append(counted, chunk);
+	}
+
+	printf("Reallocations for %zu bytes in %zu appends: %zu\n", counted->length, appends, BUILDER_REALLOCATIONS);
+	string_builder_free(counted);
+
+	StringBuilder* reserved = string_builder_new_with(&counting);
+	string_builder_reserve(reserved, 1000);
+	size_t capacity = reserved->capacity;
+	BUILDER_REALLOCATIONS = 0;
+
+	for (size_t i = 0; i < 1000; i++) {
+		string_builder_append_char(reserved, 'x');
+	}
+
+	printf("Reallocations after reserving: %zu (capacity kept: %i)\n", BUILDER_REALLOCATIONS, reserved->capacity == capacity);
+	string_builder_free(reserved);
+
+	// a copy of the finished buffer against handing it over
+	double copied = 0.0;
+	double moved = 0.0;
+	bool same_buffer = true;
+	bool same_contents = true;
+
+	for (size_t round = 0; round < 2; round++) {
+		StringBuilder* builder = string_builder_new();
+		string_builder_reserve(builder, target + 1);
+
+		for (size_t i = 0; i < appends; i++) {
+			string_builder_append(builder, chunk);
+		}
+
+		char* buffer = builder->buffer;
+		clock_t start = clock();
+
+		if (round == 0) {
+			String* built = string_builder_build(builder);
+			copied = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+			same_contents = built->length == builder->length && built->buffer[built->length] == '\0';
+			string_builder_free(builder);
+			string_free(built);
+		} else {
+			String* built = string_builder_build_move(builder);
+			moved = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+			same_buffer = built->buffer == buffer && built->buffer[built->length] == '\0';
+			same_contents = same_contents && built->length == appends * (sizeof(chunk) - 1)
+					&& memcmp(built->buffer + built->length - (sizeof(chunk) - 1), chunk, sizeof(chunk) - 1) == 0;
+			string_free(built);
+		}
+	}
+
+	printf("Build 100 MiB: copy %fs, move %fs (buffer handed over: %i, contents: %i)\n", copied, moved, same_buffer, same_contents);
+}
+
+void test_builder_format() {
+	printf("\nSTRING BUILDER FORMAT TESTS\n\n");
+
+	int64_t integers[] = { 0, 7, -7, 10, 99, 100, -1000, 123456789, 9999999999, INT64_MAX, INT64_MIN };
+	size_t integer_mismatches = 0;
+	StringBuilder* builder = string_builder_new();
+	char expected[64];
+
+	for (size_t i = 0; i < sizeof(integers) / sizeof(integers[0]); i++) {
+		string_builder_clear(builder);
+		string_builder_append_i64(builder, integers[i]);
+		int length = snprintf(expected, sizeof(expected), "%lld", (long long) integers[i]);
+		integer_mismatches += builder->length != (size_t) length || memcmp(builder->buffer, expected, length) != 0;
+	}
+
+	for (uint64_t value = 1; value != 0 && value < UINT64_MAX / 3; value = value * 3 + 1) {
+		string_builder_clear(builder);
+		string_builder_append_u64(builder, value);
+		int length = snprintf(expected, sizeof(expected), "%llu", (unsigned long long) value);
+		integer_mismatches += builder->length != (size_t) length || memcmp(builder->buffer, expected, length) != 0;
+	}
+
+	printf("Integer mismatches against snprintf: %zu\n", integer_mismatches);
+
+	// the first attempt cannot fit, so the retry path formats again after growing
+	string_builder_clear(builder);
+	string_builder_append_format(builder, "%s=%d;%0*d", "key", 42, 100, 7);
+	printf("Formatted past capacity: %zu characters, ends with 7: %i\n", builder->length, builder->buffer[builder->length - 1] == '7');
+
+	string_builder_clear(builder);
+	string_builder_append_f64(builder, 0.1);
+	string_builder_append_char(builder, ' ');
+	string_builder_append_f64(builder, -2.5e-300);
+	printf("Doubles: %.*s\n", (int) builder->length, builder->buffer);
+	string_builder_free(builder);
+
+	// formatting log lines into a reused builder only allocates until it has grown
+	Allocator counting = { _growth_allocate, _growth_reallocate, _growth_free, NULL };
+	StringBuilder* line = string_builder_new_with(&counting);
+	size_t lines = 200000;
+	size_t checksum = 0;
+
+	string_builder_reserve(line, 128);
+	BUILDER_ALLOCATIONS = 0;
+	BUILDER_REALLOCATIONS = 0;
+	clock_t start = clock();
+
+	for (size_t i = 0; i < lines; i++) {
+		string_builder_clear(line);
+		string_builder_append_format(line, "[%s] request %zu served in %.3fms from %s\n", "INFO", i, i * 0.25, "10.0.0.1");
+		checksum += line->length;
+	}
+
+	double direct = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	printf("Allocations while formatting %zu log lines: %zu\n", lines, BUILDER_ALLOCATIONS + BUILDER_REALLOCATIONS);
+
+	// the previous approach formatted into a temporary String for every call
+	start = clock();
+
+	for (size_t i = 0; i < lines; i++) {
+		string_builder_clear(line);
+		String* formatted = string_from_format("[%s] request %zu served in %.3fms from %s\n", "INFO", i, i * 0.25, "10.0.0.1");
+		string_builder_append(line, formatted->buffer);
+		string_free(formatted);
+		checksum += line->length;
+	}
+
+	double temporary = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	printf("Format %zu log lines: into the builder %fs, through a temporary %fs (%zu)\n", lines, direct, temporary, checksum);
+
+	start = clock();
+
+	for (size_t i = 0; i < lines * 5; i++) {
+		string_builder_clear(line);
+		string_builder_append_i64(line, (int64_t) (i * 2654435761u) - 1000000000);
+	}
+
+	double table = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	start = clock();
+
+	for (size_t i = 0; i < lines * 5; i++) {
+		string_builder_clear(line);
+		string_builder_append_format(line, "%lld", (long long) ((int64_t) (i * 2654435761u) - 1000000000));
+	}
+
+	double printf_integers = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	printf("Append %zu integers: digit pairs %fs, format %fs\n", lines * 5, table, printf_integers);
+
+	string_builder_free(line);
+}
+
+uint64_t _next_random(uint64_t* state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+// Digits of the shortest %.*e output that reads back as the value
+int _shortest_digits(double value) {
+	char buffer[64];
+
+	for (int precision = 0; precision < 17; precision++) {
+		snprintf(buffer, sizeof(buffer), "%.*e", precision, value);
+
+		if (strtod(buffer, NULL) == value) {
+			return precision + 1;
+		}
+	}
+
+	return 17;
+}
+
+int _formatted_digits(const char* buffer, size_t length) {
+	int digits = 0;
+	int trailing_zeros = 0;
+	bool leading = true;
+
+	for (size_t i = 0; i < length && buffer[i] != 'e'; i++) {
+		if (buffer[i] < '0' || buffer[i] > '9') {
+			continue;
+		}
+
+		if (leading && buffer[i] == '0') {
+			continue;
+		}
+
+		leading = false;
+		digits++;
+		trailing_zeros = buffer[i] == '0' ? trailing_zeros + 1 : 0;
+	}
+
+	return digits - trailing_zeros;
+}
+
+void test_numbers() {
+	printf("\nSTRING NUMBER TESTS\n\n");
+
+	struct {
+		char* text;
+		Error error;
+		int64_t value;
+	} integers[] = {
+		{ "0", OK, 0 }, { "-0", OK, 0 }, { "+12", OK, 12 }, { "000000000000000000000000123", OK, 123 },
+		{ "12345678", OK, 12345678 }, { "-1234567890123456789", OK, -1234567890123456789 },
+		{ "9223372036854775807", OK, INT64_MAX }, { "-9223372036854775808", OK, INT64_MIN },
+		{ "9223372036854775808", BAD_RANGE, 0 }, { "99999999999999999999999", BAD_RANGE, 0 },
+		{ "", BAD_FORMAT, 0 }, { "-", BAD_FORMAT, 0 }, { " 1", BAD_FORMAT, 0 }, { "12a", BAD_FORMAT, 0 },
+		{ "1234567a", BAD_FORMAT, 0 }, { "123456789012345678901x", BAD_FORMAT, 0 }, { "+-1", BAD_FORMAT, 0 },
+	};
+	size_t integer_failures = 0;
+
+	for (size_t i = 0; i < sizeof(integers) / sizeof(integers[0]); i++) {
+		int64_t value = 0;
+		Error error = string_parse_i64_cstring(integers[i].text, strlen(integers[i].text), &value);
+		integer_failures += error != integers[i].error || (error == OK && value != integers[i].value);
+	}
+
+	uint64_t state = 88172645463325252ULL;
+	uint64_t unsigned_value;
+	char text[64];
+
+	integer_failures += string_parse_u64_cstring("18446744073709551615", 20, &unsigned_value) != OK || unsigned_value != UINT64_MAX;
+	integer_failures += string_parse_u64_cstring("18446744073709551616", 20, &unsigned_value) != BAD_RANGE;
+	integer_failures += string_parse_u64_cstring("-1", 2, &unsigned_value) != BAD_FORMAT;
+
+	for (size_t i = 0; i < 100000; i++) {
+		uint64_t random = _next_random(&state) >> (i % 64);
+		int length = snprintf(text, sizeof(text), "%llu", (unsigned long long) random);
+		integer_failures += string_parse_u64_cstring(text, length, &unsigned_value) != OK || unsigned_value != random;
+	}
+
+	printf("Integer parse failures: %zu\n", integer_failures);
+
+	char* floats[] = { "0", "-0.0", "1.5", ".5", "5.", "1e10", "2.5E-3", "-inf", "NaN", "1e400", "4.9e-324", "1.7976931348623157e308" };
+	Error float_errors[] = { OK, OK, OK, OK, OK, OK, OK, OK, OK, BAD_RANGE, OK, OK };
+	char* bad_floats[] = { "", ".", "e5", "1e", "1e+", "1.2.3", "1,5", "0x10", " 1", "infinite" };
+	size_t float_failures = 0;
+	double parsed;
+
+	for (size_t i = 0; i < sizeof(floats) / sizeof(floats[0]); i++) {
+		Error error = string_parse_f64_cstring(floats[i], strlen(floats[i]), &parsed);
+		float_failures += error != float_errors[i]
+				|| (error == OK && memcmp(&parsed, &(double) { strtod(floats[i], NULL) }, sizeof(double)) != 0 && parsed == parsed);
+	}
+
+	for (size_t i = 0; i < sizeof(bad_floats) / sizeof(bad_floats[0]); i++) {
+		float_failures += string_parse_f64_cstring(bad_floats[i], strlen(bad_floats[i]), &parsed) != BAD_FORMAT;
+	}
+
+	// random bit patterns through the formatter, and printf output through the parser
+	size_t round_trip_failures = 0;
+	size_t longer_than_shortest = 0;
+	size_t samples = 200000;
+	char formatted[STRING_F64_MAX_LENGTH + 1];
+
+	for (size_t i = 0; i < samples; i++) {
+		uint64_t bits = _next_random(&state);
+		double value;
+		memcpy(&value, &bits, sizeof(value));
+
+		if (value != value || value - value != 0) {
+			continue;
+		}
+
+		size_t length = string_format_f64(value, formatted);
+		formatted[length] = '\0';
+
+		float_failures += length > STRING_F64_MAX_LENGTH;
+		round_trip_failures += strtod(formatted, NULL) != value;
+		round_trip_failures += string_parse_f64_cstring(formatted, length, &parsed) != OK || parsed != value;
+		longer_than_shortest += _formatted_digits(formatted, length) > _shortest_digits(value);
+
+		// rounding to fewer digits can push the largest doubles out of range
+		int printed = snprintf(text, sizeof(text), "%.*g", (int) (i % 20) + 1, value);
+		double expected = strtod(text, NULL);
+		Error error = string_parse_f64_cstring(text, printed, &parsed);
+		round_trip_failures += isinf(expected) ? error != BAD_RANGE : error != OK || parsed != expected;
+	}
+
+	printf("Float parse failures: %zu, round trip failures: %zu, longer than shortest: %zu of %zu\n",
+			float_failures, round_trip_failures, longer_than_shortest, samples);
+
+	StringBuilder* builder = string_builder_new();
+	double examples[] = { 0.1, 1.0 / 3, 1500, 1e21, 1e-7, -2.5e-300, 123456.789 };
+
+	for (size_t i = 0; i < sizeof(examples) / sizeof(examples[0]); i++) {
+		string_builder_append_f64(builder, examples[i]);
+		string_builder_append_char(builder, ' ');
+	}
+
+	printf("Formatted: %.*s\n", (int) builder->length, builder->buffer);
+
+	// the benchmark inputs are formatted once up front
+	size_t count = 1000000;
+	char (*integer_texts)[24] = malloc(count * sizeof(*integer_texts));
+	char (*float_texts)[32] = malloc(count * sizeof(*float_texts));
+	size_t* integer_lengths = malloc(count * sizeof(size_t));
+	size_t* float_lengths = malloc(count * sizeof(size_t));
+	double* values = malloc(count * sizeof(double));
+
+	for (size_t i = 0; i < count; i++) {
+		integer_lengths[i] = snprintf(integer_texts[i], sizeof(*integer_texts), "%lld", (long long) (_next_random(&state) >> (i % 40)));
+		values[i] = (double) (_next_random(&state) >> 11) / (1 << 20);
+		float_lengths[i] = snprintf(float_texts[i], sizeof(*float_texts), "%.*f", (int) (i % 6), values[i]);
+	}
+
+	size_t mismatches = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		int64_t integer;
+		double value;
+		string_parse_i64_cstring(integer_texts[i], integer_lengths[i], &integer);
+		string_parse_f64_cstring(float_texts[i], float_lengths[i], &value);
+		mismatches += integer != strtoll(integer_texts[i], NULL, 10) || value != strtod(float_texts[i], NULL);
+	}
+
+	uint64_t integer_sum = 0;
+	double float_sum = 0;
+	clock_t start = clock();
+
+	for (size_t i = 0; i < count; i++) {
+		int64_t value;
+		string_parse_i64_cstring(integer_texts[i], integer_lengths[i], &value);
+		integer_sum += (uint64_t) value;
+	}
+
+	double parse_i64 = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	start = clock();
+
+	for (size_t i = 0; i < count; i++) {
+		integer_sum += (uint64_t) strtoll(integer_texts[i], NULL, 10);
+	}
+
+	double strtoll_time = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	start = clock();
+
+	for (size_t i = 0; i < count; i++) {
+		double value;
+		string_parse_f64_cstring(float_texts[i], float_lengths[i], &value);
+		float_sum += value;
+	}
+
+	double parse_f64 = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	start = clock();
+
+	for (size_t i = 0; i < count; i++) {
+		float_sum += strtod(float_texts[i], NULL);
+	}
+
+	double strtod_time = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	size_t written = 0;
+	start = clock();
+
+	for (size_t i = 0; i < count; i++) {
+		written += string_format_f64(values[i], formatted);
+	}
+
+	double format_f64 = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	start = clock();
+
+	for (size_t i = 0; i < count; i++) {
+		written += snprintf(text, sizeof(text), "%.17g", values[i]);
+	}
+
+	double snprintf_time = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	printf("Parsed values differing from strtoll and strtod: %zu of %zu\n", mismatches, count);
+	printf("Parse %zu integers: string_parse_i64 %fs, strtoll %fs\n", count, parse_i64, strtoll_time);
+	printf("Parse %zu doubles: string_parse_f64 %fs, strtod %fs\n", count, parse_f64, strtod_time);
+	printf("Format %zu doubles: string_format_f64 %fs, snprintf %%.17g %fs (checksum %zu)\n",
+			count, format_f64, snprintf_time, (written + (size_t) integer_sum + (size_t) float_sum) & 0xff);
+
+	string_builder_free(builder);
+	free(integer_texts);
+	free(float_texts);
+	free(integer_lengths);
+	free(float_lengths);
+	free(values);
+}